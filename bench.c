@@ -0,0 +1,2038 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ *  @file   bench.c
+ *  @author Marc Zimmermann (tooreht@gmail.com)
+ *  @date   December, 2012
+ *  @brief  Benchmarks of doublyLinkedList.
+ *
+ *  This programm measures the throughput of some list operations.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "dll.h"
+#include "dll_unrolled.h"
+#include "dll_concurrent.h"
+#include "dll_lockfree.h"
+#include "dll_snapshot.h"
+
+int value = 1;
+
+/**
+ * The data is not owned by the list, so nothing has to be freed.
+ *
+ * @param void* data
+ * @return void
+ */
+void freeFn(void *data)
+{
+}
+
+/**
+ * Returns the current time in seconds.
+ *
+ * @param void
+ * @return double: seconds
+ */
+double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Uses the list as a queue: keeps depth elements queued while
+ * ops elements are pushed to the tail and popped from the head.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long depth: number of queued elements
+ * @param unsigned long ops: number of push/pop pairs
+ * @return double: elapsed seconds
+ */
+double queue(dll_t *list, unsigned long depth, unsigned long ops)
+{
+    unsigned long i;
+
+    dll_registerFreeFn(list, freeFn);
+
+    double start = now();
+
+    for (i = 0; i < depth; i++)
+        dll_pushTail(list, &value);
+
+    for (i = 0; i < ops; i++)
+    {
+        dll_pushTail(list, &value);
+        dll_popHead(list);
+    }
+
+    double elapsed = now() - start;
+
+    dll_clear(list);
+
+    return elapsed;
+}
+
+/**
+ * Compares push/pop throughput of malloc'ed and pooled nodes.
+ *
+ * @param unsigned long ops: number of push/pop pairs
+ * @return void
+ */
+void benchPool(unsigned long ops)
+{
+    unsigned long depth;
+
+    puts("push/pop queue        depth    malloc Mops/s    pool Mops/s");
+
+    for (depth = 1; depth <= 1000000; depth *= 100)
+    {
+        double m = queue(dll_create(), depth, ops);
+        double p = queue(dll_createWithPool(4096), depth, ops);
+
+        printf("                 %10lu    %13.2f    %11.2f\n",
+               depth, ops / m / 1e6, ops / p / 1e6);
+    }
+}
+
+/**
+ * Fills a list with n elements, either one by one or in bulk.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void **items: array of n data pointers
+ * @param unsigned long n: number of elements
+ * @param int bulk: 1 to use dll_pushTailBulk, 2 to use dll_pushHeadBulk
+ * @return double: elapsed seconds
+ */
+double fillList(dll_t *list, void **items, unsigned long n, int bulk)
+{
+    unsigned long i;
+
+    dll_registerFreeFn(list, freeFn);
+
+    double start = now();
+
+    if (bulk == 2)
+    {
+        if (!dll_pushHeadBulk(list, items, n))
+            puts("ERROR: dll_pushHeadBulk failed");
+    }
+    else if (bulk)
+    {
+        if (!dll_pushTailBulk(list, items, n))
+            puts("ERROR: dll_pushTailBulk failed");
+    }
+    else
+    {
+        for (i = 0; i < n; i++)
+            dll_pushTail(list, items[i]);
+    }
+
+    double elapsed = now() - start;
+
+    dll_clear(list);
+
+    return elapsed;
+}
+
+/**
+ * Returns the best throughput of some fills, so the first touch
+ * of fresh heap memory does not count.
+ *
+ * @param int pooled: use dll_createWithPool
+ * @param void **items: array of n data pointers
+ * @param unsigned long n: number of elements
+ * @param int bulk: 1 to use dll_pushTailBulk, 2 to use dll_pushHeadBulk
+ * @return double: million elements per second
+ */
+double bestFill(int pooled, void **items, unsigned long n, int bulk)
+{
+    double best = 0, elapsed;
+    int i;
+
+    for (i = 0; i < 5; i++)
+    {
+        elapsed = fillList(pooled ? dll_createWithPool(4096) : dll_create(), items, n, bulk);
+        if (!best || elapsed < best)
+            best = elapsed;
+    }
+
+    return n / best / 1e6;
+}
+
+/**
+ * Compares filling a list with dll_pushTail, dll_pushTailBulk and
+ * dll_pushHeadBulk.
+ *
+ * @param unsigned long n: number of elements
+ * @return void
+ */
+void benchBulk(unsigned long n)
+{
+    void **items = malloc(n * sizeof(void*));
+    unsigned long i;
+
+    for (i = 0; i < n; i++)
+        items[i] = &value;
+
+    puts("fill                 nodes      loop Mops/s    bulk Mops/s   head bulk Mops/s");
+
+    printf("             %14s    %12.2f    %11.2f    %15.2f\n", "malloc",
+           bestFill(0, items, n, 0), bestFill(0, items, n, 1), bestFill(0, items, n, 2));
+    printf("             %14s    %12.2f    %11.2f    %15.2f\n", "pool",
+           bestFill(1, items, n, 0), bestFill(1, items, n, 1), bestFill(1, items, n, 2));
+
+    free(items);
+}
+
+/**
+ * Measures how long the caller is blocked tearing down a list of
+ * n elements, with dll_clear or dll_clearDeferred.
+ *
+ * @param unsigned long n: number of elements
+ * @param int deferred: use dll_clearDeferred
+ * @return double: elapsed milliseconds
+ */
+double clearList(unsigned long n, int deferred)
+{
+    dll_t *list = dll_create();
+    unsigned long i;
+
+    dll_registerFreeFn(list, freeFn);
+
+    for (i = 0; i < n; i++)
+        dll_pushTail(list, &value);
+
+    double start = now();
+
+    if (deferred)
+        dll_clearDeferred(list);
+    else
+        dll_clear(list);
+
+    double elapsed = now() - start;
+
+    dll_reclaimWait();
+
+    return elapsed * 1e3;
+}
+
+/**
+ * Compares the time the caller spends in dll_clear and dll_clearDeferred.
+ *
+ * @param unsigned long n: number of elements
+ * @return void
+ */
+void benchClear(unsigned long n)
+{
+    puts("clear                nodes       clear ms     deferred ms");
+
+    printf("                 %10lu    %11.3f    %12.3f\n",
+           n, clearList(n, 0), clearList(n, 1));
+}
+
+/**
+ * Compares the integers pointed to by a and b.
+ *
+ * @param void *a: pointer to an int
+ * @param void *b: pointer to an int
+ * @return int: <0, 0 or >0
+ */
+int compareFn(void *a, void *b)
+{
+    int x = *(int*)a, y = *(int*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sorts a list of n random integers with dll_sortParallel.
+ *
+ * @param void **items: array of n data pointers
+ * @param unsigned long n: number of elements
+ * @param unsigned int threads: number of threads
+ * @return double: elapsed seconds
+ */
+double sortList(void **items, unsigned long n, unsigned int threads)
+{
+    dll_t *list = dll_createWithPool(4096);
+
+    dll_registerFreeFn(list, freeFn);
+    dll_registerCompareFn(list, compareFn);
+    dll_pushTailBulk(list, items, n);
+
+    double start = now();
+
+    dll_sortParallel(list, threads);
+
+    double elapsed = now() - start;
+
+    dll_clear(list);
+
+    return elapsed;
+}
+
+/**
+ * Shows how dll_sortParallel scales from 1 to maxThreads threads.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned int maxThreads: maximum number of threads
+ * @return void
+ */
+void benchSort(unsigned long n, unsigned int maxThreads)
+{
+    int *values = malloc(n * sizeof(int));
+    void **items = malloc(n * sizeof(void*));
+    unsigned long i;
+    unsigned int threads;
+    double single = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        values[i] = rand();
+        items[i] = &values[i];
+    }
+
+    puts("sort                 threads      Mnodes/s        speedup");
+
+    for (threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double elapsed = sortList(items, n, threads);
+
+        if (threads == 1)
+            single = elapsed;
+
+        printf("                 %10u    %10.2f    %11.2f\n",
+               threads, n / elapsed / 1e6, single / elapsed);
+    }
+
+    free(items);
+    free(values);
+}
+
+/**
+ * A CPU heavy callback: mixes the integer a few hundred times and
+ * stores the result in it.
+ *
+ * @param void *data: pointer to an int
+ * @return void
+ */
+void mixInt(void *data)
+{
+    unsigned int x = *(int*)data, i;
+
+    for (i = 0; i < 256; i++)
+        x = x * 2654435761u + (x >> 13);
+
+    *(int*)data = x;
+}
+
+/**
+ * Adds the integer to the accumulator, a long allocated at the first one.
+ *
+ * @param void *acc: pointer to a long or NULL
+ * @param void *data: pointer to an int
+ * @return void*: the accumulator
+ */
+void* addInt(void *acc, void *data)
+{
+    long *sum = acc;
+
+    if (!sum)
+    {
+        sum = malloc(sizeof(long));
+        *sum = 0;
+    }
+
+    mixInt(data);
+    *sum += *(int*)data;
+
+    return sum;
+}
+
+/**
+ * Adds two accumulators of addInt.
+ *
+ * @param void *left: pointer to a long
+ * @param void *right: pointer to a long, freed
+ * @return void*: left
+ */
+void* addSums(void *left, void *right)
+{
+    *(long*)left += *(long*)right;
+    free(right);
+
+    return left;
+}
+
+/**
+ * Shows how dll_parallelTraverse and dll_reduce with a CPU heavy
+ * callback scale from 1 to maxThreads threads.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned int maxThreads: maximum number of threads
+ * @return void
+ */
+void benchParallel(unsigned long n, unsigned int maxThreads)
+{
+    int *values = malloc(n * sizeof(int));
+    void **items = malloc(n * sizeof(void*));
+    dll_t *list = dll_createWithPool(4096);
+    unsigned long i;
+    unsigned int threads;
+    double single[2] = {0, 0};
+
+    for (i = 0; i < n; i++)
+    {
+        values[i] = rand();
+        items[i] = &values[i];
+    }
+
+    dll_registerFreeFn(list, freeFn);
+    dll_pushTailBulk(list, items, n);
+
+    puts("parallel             threads  traverse Mn/s  reduce Mn/s    speedup");
+
+    for (threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double start = now(), elapsed[2];
+
+        dll_parallelTraverse(list, mixInt, threads);
+        elapsed[0] = now() - start;
+
+        start = now();
+        free(dll_reduce(list, addInt, addSums, threads));
+        elapsed[1] = now() - start;
+
+        if (threads == 1)
+        {
+            single[0] = elapsed[0];
+            single[1] = elapsed[1];
+        }
+
+        printf("                 %10u    %10.2f   %10.2f  %5.2f/%5.2f\n",
+               threads, n / elapsed[0] / 1e6, n / elapsed[1] / 1e6,
+               single[0] / elapsed[0], single[1] / elapsed[1]);
+    }
+
+    dll_clear(list);
+    free(items);
+    free(values);
+}
+
+/**
+ * Compares selecting the k smallest of n random integers with
+ * dll_topK and dll_nthElement against sorting the whole list.
+ *
+ * @param unsigned long n: number of elements
+ * @return void
+ */
+void benchTopK(unsigned long n)
+{
+    int *values = malloc(n * sizeof(int));
+    void **items = malloc(n * sizeof(void*));
+    unsigned long i, k;
+
+    for (i = 0; i < n; i++)
+    {
+        values[i] = rand();
+        items[i] = &values[i];
+    }
+
+    puts("select                   k        sort ms        topK ms     nth ms");
+
+    for (k = 10; k <= n / 100; k *= 10)
+    {
+        dll_t *list = dll_createWithPool(4096);
+        double elapsed[3];
+
+        dll_registerFreeFn(list, freeFn);
+        dll_registerCompareFn(list, compareFn);
+        dll_pushTailBulk(list, items, n);
+
+        double start = now();
+        dll_clear(dll_topK(list, k));
+        elapsed[1] = now() - start;
+
+        start = now();
+        dll_nthElement(list, k);
+        elapsed[2] = now() - start;
+
+        start = now();
+        dll_sort(list);
+        elapsed[0] = now() - start;
+
+        printf("                 %10lu    %11.2f    %11.2f    %7.2f\n",
+               k, elapsed[0] * 1e3, elapsed[1] * 1e3, elapsed[2] * 1e3);
+
+        dll_clear(list);
+    }
+
+    free(items);
+    free(values);
+}
+
+/**
+ * Compares keeping a list of n random integers sorted by sorting it
+ * after every batch of pushs and with dll_insertSorted in sorted mode.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long batch: number of pushs per sort
+ * @return void
+ */
+void benchSorted(unsigned long n, unsigned long batch)
+{
+    int *values = malloc(n * sizeof(int));
+    double elapsed[2];
+    unsigned long i;
+    int mode;
+
+    for (i = 0; i < n; i++)
+        values[i] = rand();
+
+    for (mode = 0; mode < 2; mode++)
+    {
+        dll_t *list = dll_createWithPool(4096);
+
+        dll_registerFreeFn(list, freeFn);
+        dll_registerCompareFn(list, compareFn);
+        if (mode)
+            dll_enableSorted(list);
+
+        double start = now();
+
+        for (i = 0; i < n; i++)
+        {
+            if (mode)
+            {
+                dll_insertSorted(list, &values[i]);
+            }
+            else
+            {
+                dll_pushTail(list, &values[i]);
+                if ((i + 1) % batch == 0 || i == n - 1)
+                    dll_sort(list);
+            }
+        }
+
+        elapsed[mode] = now() - start;
+
+        dll_clear(list);
+    }
+
+    puts("keep sorted          nodes   batch sort ms  insert ms");
+
+    printf("                 %10lu    %12.2f    %7.2f\n",
+           n, elapsed[0] * 1e3, elapsed[1] * 1e3);
+
+    free(values);
+}
+
+/**
+ * A big payload with a small sort key.
+ */
+typedef struct
+{
+    char name[248];
+    int age;
+} record_t;
+
+/**
+ * Compares the records pointed to by a and b by age.
+ *
+ * @param void *a: pointer to a record
+ * @param void *b: pointer to a record
+ * @return int: <0, 0 or >0
+ */
+int compareAge(void *a, void *b)
+{
+    int x = ((record_t*)a)->age, y = ((record_t*)b)->age;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Returns the age of the record as sort key.
+ *
+ * @param void *data: pointer to a record
+ * @return unsigned long long: key
+ */
+unsigned long long keyAge(void *data)
+{
+    return ((record_t*)data)->age;
+}
+
+/**
+ * Compares dll_sort, dll_sortByKey and dll_sortByIntKey on big records.
+ *
+ * @param unsigned long n: number of elements
+ * @return void
+ */
+void benchSortByKey(unsigned long n)
+{
+    record_t *records = malloc(n * sizeof(record_t));
+    void **items = malloc(n * sizeof(void*));
+    unsigned long i;
+    double elapsed[3];
+    int byKey;
+
+    for (i = 0; i < n; i++)
+    {
+        records[i].age = rand() % 100;
+        items[i] = &records[i];
+    }
+
+    for (byKey = 0; byKey < 3; byKey++)
+    {
+        dll_t *list = dll_createWithPool(4096);
+
+        dll_registerFreeFn(list, freeFn);
+        dll_registerCompareFn(list, compareAge);
+        dll_pushTailBulk(list, items, n);
+
+        double start = now();
+
+        if (byKey == 2)
+            dll_sortByIntKey(list, offsetof(record_t, age), DLL_KEY_I32);
+        else if (byKey)
+            dll_sortByKey(list, keyAge);
+        else
+            dll_sort(list);
+
+        elapsed[byKey] = now() - start;
+
+        dll_clear(list);
+    }
+
+    puts("sort records         nodes     sort Mnodes/s   key Mnodes/s   int key Mnodes/s");
+
+    printf("                 %10lu    %13.2f    %11.2f    %15.2f\n",
+           n, n / elapsed[0] / 1e6, n / elapsed[1] / 1e6, n / elapsed[2] / 1e6);
+
+    free(items);
+    free(records);
+}
+
+/**
+ * Frees data allocated by the benchmark.
+ *
+ * @param void* data
+ * @return void
+ */
+void freeData(void *data)
+{
+    free(data);
+}
+
+/**
+ * Writes the integer into the buffer.
+ *
+ * @param void *data: pointer to an int
+ * @param void *buffer: buffer
+ * @param unsigned long size: size of the buffer
+ * @return unsigned long: bytes needed
+ */
+unsigned long serializeInt(void *data, void *buffer, unsigned long size)
+{
+    if (size >= sizeof(int))
+        *(int*)buffer = *(int*)data;
+
+    return sizeof(int);
+}
+
+/**
+ * Creates an integer from the buffer.
+ *
+ * @param void *buffer: buffer
+ * @param unsigned long size: size of the buffer
+ * @return void*: pointer to a new int
+ */
+void* deserializeInt(void *buffer, unsigned long size)
+{
+    int *data = malloc(sizeof(int));
+
+    if (data)
+        *data = *(int*)buffer;
+
+    return data;
+}
+
+/**
+ * Compares loading n integers from a text file with dll_pushTail
+ * and from a file written by dll_save with dll_load.
+ *
+ * @param unsigned long n: number of elements
+ * @return void
+ */
+void benchLoad(unsigned long n)
+{
+    const char *text = "bench.txt", *binary = "bench.dll";
+    dll_t *list = dll_create();
+    FILE *fp = fopen(text, "w");
+    unsigned long i;
+    int v;
+
+    dll_registerFreeFn(list, freeData);
+    dll_registerSerializeFn(list, serializeInt);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    for (i = 0; i < n; i++)
+    {
+        int *data = malloc(sizeof(int));
+        *data = rand();
+        fprintf(fp, "%d\n", *data);
+        dll_pushTail(list, data);
+    }
+
+    fclose(fp);
+    dll_save(list, binary);
+    dll_clear(list);
+
+    list = dll_create();
+    dll_registerFreeFn(list, freeData);
+
+    double start = now();
+
+    fp = fopen(text, "r");
+    while (fscanf(fp, "%d", &v) == 1)
+    {
+        int *data = malloc(sizeof(int));
+        *data = v;
+        dll_pushTail(list, data);
+    }
+    fclose(fp);
+
+    double parsed = now() - start;
+
+    dll_clear(list);
+
+    list = dll_create();
+    dll_registerFreeFn(list, freeData);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    start = now();
+    dll_load(list, binary);
+    double loaded = now() - start;
+
+    puts("load                 nodes        text ms      dll_load ms");
+
+    printf("                 %10lu    %11.2f    %13.2f\n",
+           list->size, parsed * 1e3, loaded * 1e3);
+
+    dll_clear(list);
+    remove(text);
+    remove(binary);
+}
+
+long long checksum = 0;
+
+/**
+ * Adds the integer to the checksum.
+ *
+ * @param void *data: pointer to an int
+ * @return void
+ */
+void sumInt(void *data)
+{
+    checksum += *(int*)data;
+}
+
+/**
+ * Compares the time until a list of n integers is loaded and summed up,
+ * loaded with dll_load and mapped with dlls_open.
+ *
+ * @param unsigned long n: number of elements
+ * @return void
+ */
+void benchSnapshot(unsigned long n)
+{
+    const char *binary = "bench.dll", *snapshot = "bench.snap";
+    dll_t *list = dll_create();
+    dlls_t *snap;
+    unsigned long i;
+    long long sums[2];
+
+    dll_registerFreeFn(list, freeData);
+    dll_registerSerializeFn(list, serializeInt);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    for (i = 0; i < n; i++)
+    {
+        int *data = malloc(sizeof(int));
+        *data = rand();
+        dll_pushTail(list, data);
+    }
+
+    dll_save(list, binary);
+    dlls_write(list, snapshot, sizeof(int));
+    dll_clear(list);
+
+    double start = now();
+
+    list = dll_create();
+    dll_registerFreeFn(list, freeData);
+    dll_registerDeserializeFn(list, deserializeInt);
+    dll_load(list, binary);
+    double loaded = now() - start;
+    checksum = 0;
+    dll_traverse(list, sumInt);
+    double loadedSum = now() - start;
+    sums[0] = checksum;
+
+    start = now();
+    snap = dlls_open(snapshot);
+    double mapped = now() - start;
+    checksum = 0;
+    dlls_traverse(snap, sumInt);
+    double mappedSum = now() - start;
+    sums[1] = checksum;
+
+    puts("open                 nodes    dll_load ms     +sum ms    dlls_open ms     +sum ms");
+
+    printf("                 %10lu    %11.2f    %8.2f    %12.3f    %8.2f\n",
+           n, loaded * 1e3, loadedSum * 1e3, mapped * 1e3, mappedSum * 1e3);
+
+    if (sums[0] != sums[1])
+        puts("ERROR: snapshot differs from the list");
+
+    dlls_close(snap);
+    dll_clear(list);
+    remove(binary);
+    remove(snapshot);
+}
+
+/**
+ * Looks up random integers in a snapshot of a list of n integers in
+ * sorted mode, which dlls_search does binary, and in a snapshot of the
+ * same list unsorted, which is searched from head to tail. Checks
+ * dlls_get and the walks with dlls_next and dlls_prev against the list.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long lookups: number of binary searches
+ * @return void
+ */
+void benchSnapshotSearch(unsigned long n, unsigned long lookups)
+{
+    const char *sorted = "bench-sorted.snap", *unsorted = "bench.snap";
+    int *values = malloc(n * sizeof(int)), missing = -1;
+    dll_t *list = dll_create();
+    dlls_t *snap[2];
+    dlls_node_t *node;
+    dll_node_t *n2;
+    unsigned long i, linear = lookups / 1000 + 1;
+    double elapsed[2], start;
+    short int ok = 1;
+
+    dll_registerFreeFn(list, freeFn);
+    dll_registerCompareFn(list, compareFn);
+
+    for (i = 0; i < n; i++)
+    {
+        values[i] = rand();
+        dll_pushTail(list, &values[i]);
+    }
+
+    dlls_write(list, unsorted, sizeof(int));
+    dll_enableSorted(list);
+    dlls_write(list, sorted, sizeof(int));
+
+    snap[0] = dlls_open(sorted);
+    snap[1] = dlls_open(unsorted);
+
+    if (!snap[0] || !snap[1])
+    {
+        dlls_close(snap[0]);
+        dlls_close(snap[1]);
+        dll_clear(list);
+        free(values);
+        return;
+    }
+
+    dlls_registerCompareFn(snap[0], compareFn);
+    dlls_registerCompareFn(snap[1], compareFn);
+
+    start = now();
+    for (i = 0; i < lookups; i++)
+    {
+        node = dlls_search(snap[0], &values[rand() % n]);
+        ok &= node != NULL;
+    }
+    ok &= !dlls_search(snap[0], &missing);
+    elapsed[0] = (now() - start) / (lookups + 1);
+
+    start = now();
+    for (i = 0; i < linear; i++)
+    {
+        node = dlls_search(snap[1], &values[rand() % n]);
+        ok &= node != NULL;
+    }
+    elapsed[1] = (now() - start) / linear;
+
+    for (i = 0, n2 = dll_head(list), node = dlls_head(snap[0]); n2 && node; i++, n2 = n2->next, node = dlls_next(node))
+        ok &= *(int*)dlls_data(node) == *(int*)n2->data && (i % 97 || dlls_get(snap[0], i) == node);
+    ok &= !n2 && !node && i == dlls_size(snap[0]);
+
+    for (n2 = dll_tail(list), node = dlls_tail(snap[0]); n2 && node; n2 = n2->prev, node = dlls_prev(node))
+        ok &= *(int*)dlls_data(node) == *(int*)n2->data;
+    ok &= !n2 && !node;
+
+    puts("snapshot search      nodes   binary us   linear us");
+
+    printf("                 %10lu    %8.3f    %8.2f\n", n, elapsed[0] * 1e6, elapsed[1] * 1e6);
+
+    if (!ok)
+        puts("ERROR: snapshot differs from the list");
+
+    dlls_close(snap[0]);
+    dlls_close(snap[1]);
+    dll_clear(list);
+    free(values);
+    remove(sorted);
+    remove(unsorted);
+}
+
+/**
+ * State of a reader thread of the stream benchmark.
+ */
+typedef struct
+{
+    dll_streamIter_t it;
+    long long sum;
+} stream_reader_t;
+
+/**
+ * Sums up the elements of a stream while it is loading.
+ *
+ * @param void *arg: reader state
+ * @return void*: NULL
+ */
+void* streamReader(void *arg)
+{
+    stream_reader_t *r = arg;
+    dll_node_t *node;
+
+    while ((node = dll_streamNext(&r->it)))
+        r->sum += *(int*)node->data;
+
+    return NULL;
+}
+
+/**
+ * Compares the time until the first element and until all elements of
+ * a file of n integers are summed up, with dll_load and dll_streamLoad.
+ * A second stream is read by the main thread and a reader thread, the
+ * main thread releases the nodes both passed, the most nodes the list
+ * held at once are reported.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long window: loader window of the stream
+ * @return void
+ */
+void benchStream(unsigned long n, unsigned long window)
+{
+    const char *binary = "bench.dll";
+    dll_t *list = dll_create();
+    dll_stream_t *stream;
+    dll_streamIter_t it;
+    stream_reader_t reader;
+    pthread_t tid;
+    dll_node_t *node;
+    unsigned long i, held, peak = 0;
+    long long sums[3];
+
+    dll_registerFreeFn(list, freeData);
+    dll_registerSerializeFn(list, serializeInt);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    for (i = 0; i < n; i++)
+    {
+        int *data = malloc(sizeof(int));
+        *data = rand();
+        dll_pushTail(list, data);
+    }
+
+    dll_save(list, binary);
+    dll_clear(list);
+
+    list = dll_create();
+    dll_registerFreeFn(list, freeData);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    double start = now();
+    dll_load(list, binary);
+    double loadFirst = now() - start;
+    checksum = 0;
+    dll_traverse(list, sumInt);
+    double loadAll = now() - start;
+    sums[0] = checksum;
+
+    dll_clear(list);
+
+    list = dll_create();
+    dll_registerFreeFn(list, freeData);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    start = now();
+    stream = dll_streamLoad(list, binary, window);
+    dll_streamIter(&it, stream);
+    checksum = 0;
+    node = dll_streamNext(&it);
+    double streamFirst = now() - start;
+    for (; node; node = dll_streamNext(&it))
+        checksum += *(int*)node->data;
+    dll_streamFinish(stream);
+    double streamAll = now() - start;
+    sums[1] = checksum;
+
+    dll_clear(list);
+
+    list = dll_create();
+    dll_registerFreeFn(list, freeData);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    stream = dll_streamLoad(list, binary, window);
+    dll_streamIter(&it, stream);
+    dll_streamIter(&reader.it, stream);
+    reader.sum = 0;
+    pthread_create(&tid, NULL, streamReader, &reader);
+    checksum = 0;
+    for (i = 0; (node = dll_streamNext(&it)); i++)
+    {
+        checksum += *(int*)node->data;
+
+        if (i % 1024 == 0 && (held = dll_streamRelease(stream)) > peak)
+            peak = held;
+    }
+    pthread_join(tid, NULL);
+    dll_streamFinish(stream);
+    sums[2] = checksum;
+
+    puts("stream               nodes   load first/all ms   stream first/all ms   released peak");
+
+    printf("                 %10lu    %7.2f / %7.2f     %7.3f / %7.2f     %13lu\n",
+           n, loadFirst * 1e3, loadAll * 1e3, streamFirst * 1e3, streamAll * 1e3, peak);
+
+    if (sums[0] != sums[1] || sums[0] != sums[2] || sums[0] != reader.sum)
+        puts("ERROR: stream differs from the list");
+
+    if (window && peak > window + 3 * 4096)
+        puts("ERROR: stream release does not bound the list");
+
+    dll_clear(list);
+    remove(binary);
+}
+
+/**
+ * Returns a random key, to shuffle a list with dll_sortByKey.
+ *
+ * @param void *data: ignored
+ * @return unsigned long long: random key
+ */
+unsigned long long randomKey(void *data)
+{
+    return rand();
+}
+
+/**
+ * Measures dll_traverse on a list of n integers whose nodes got
+ * scattered by a shuffle, before and after dll_compact, and the longest
+ * slice of an incremental compaction with dll_compactStep.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long slice: nodes per step
+ * @return void
+ */
+void benchCompact(unsigned long n, unsigned long slice)
+{
+    int *values = malloc(n * sizeof(int));
+    void **items = malloc(n * sizeof(void*));
+    unsigned long i;
+    double elapsed[4], start, longest = 0;
+    int incremental;
+
+    for (i = 0; i < n; i++)
+    {
+        values[i] = rand();
+        items[i] = &values[i];
+    }
+
+    for (incremental = 0; incremental < 2; incremental++)
+    {
+        dll_t *list = dll_createWithPool(4096);
+
+        dll_registerFreeFn(list, freeFn);
+        dll_pushTailBulk(list, items, n);
+        dll_sortByKey(list, randomKey);
+
+        start = now();
+        dll_traverse(list, sumInt);
+        elapsed[0] = now() - start;
+
+        start = now();
+        if (incremental)
+        {
+            double step = now();
+
+            while (dll_compactStep(list, slice))
+            {
+                if (now() - step > longest)
+                    longest = now() - step;
+                step = now();
+            }
+        }
+        else
+        {
+            dll_compact(list);
+        }
+        elapsed[incremental + 1] = now() - start;
+
+        start = now();
+        dll_traverse(list, sumInt);
+        elapsed[3] = now() - start;
+
+        dll_clear(list);
+    }
+
+    puts("compact              nodes  scattered ms    compact ms   steps ms / max   compacted ms");
+
+    printf("                 %10lu      %8.2f      %8.2f    %7.2f / %5.3f       %8.2f\n",
+           n, elapsed[0] * 1e3, elapsed[1] * 1e3, elapsed[2] * 1e3, longest * 1e3, elapsed[3] * 1e3);
+
+    free(items);
+    free(values);
+}
+
+/**
+ * Compares dll_traverse, dll_get and dll_search with dllu_traverse,
+ * dllu_get and dllu_search on the same n integers.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long gets: number of random dll_get/dllu_get calls
+ * @return void
+ */
+void benchUnrolled(unsigned long n, unsigned long gets)
+{
+    int *values = malloc(n * sizeof(int));
+    unsigned long *indexes = malloc(gets * sizeof(unsigned long));
+    dll_t *list = dll_create();
+    dllu_t *unrolled = dllu_create();
+    unsigned long i;
+    long long sums[2];
+    double elapsed[6], start;
+    int missing = -1;
+    void *found[2];
+
+    dll_registerFreeFn(list, freeFn);
+    dll_registerCompareFn(list, compareFn);
+    dllu_registerFreeFn(unrolled, freeFn);
+    dllu_registerCompareFn(unrolled, compareFn);
+
+    for (i = 0; i < n; i++)
+    {
+        values[i] = rand();
+
+        if (!dll_pushTail(list, &values[i]) || !dllu_pushTail(unrolled, &values[i]).node)
+            break;
+    }
+
+    for (i = 0; i < gets; i++)
+        indexes[i] = rand() % n;
+
+    checksum = 0;
+    start = now();
+    dll_traverse(list, sumInt);
+    elapsed[0] = now() - start;
+    sums[0] = checksum;
+
+    checksum = 0;
+    start = now();
+    dllu_traverse(unrolled, sumInt);
+    elapsed[1] = now() - start;
+    sums[1] = checksum;
+
+    start = now();
+    for (i = 0; i < gets; i++)
+        checksum += *(int*)dll_get(list, indexes[i])->data;
+    elapsed[2] = now() - start;
+
+    start = now();
+    for (i = 0; i < gets; i++)
+        checksum -= *(int*)dllu_get(unrolled, indexes[i]);
+    elapsed[3] = now() - start;
+
+    start = now();
+    found[0] = dll_search(list, &missing, 1);
+    elapsed[4] = now() - start;
+
+    start = now();
+    found[1] = dllu_search(unrolled, &missing, 1).node;
+    elapsed[5] = now() - start;
+
+    puts("unrolled             nodes   traverse ms dll/dllu    get us dll/dllu   search ms dll/dllu");
+
+    printf("                 %10lu     %7.2f / %7.2f   %7.2f / %6.2f     %7.2f / %7.2f\n",
+           n, elapsed[0] * 1e3, elapsed[1] * 1e3, elapsed[2] / gets * 1e6, elapsed[3] / gets * 1e6,
+           elapsed[4] * 1e3, elapsed[5] * 1e3);
+
+    if (sums[0] != sums[1] || checksum != sums[1] || found[0] || found[1])
+        puts("ERROR: unrolled list differs from the list");
+
+    dll_clear(list);
+    dllu_clear(unrolled);
+    free(indexes);
+    free(values);
+}
+
+/**
+ * Checks that an unrolled list holds the same data pointers as a list,
+ * walking both from the head and from the tail.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dllu_t *unrolled: pointer to the unrolled doubly linked list
+ * @return int: equal
+ */
+short int sameUnrolled(dll_t *list, dllu_t *unrolled)
+{
+    dllu_pos_t pos;
+    dll_node_t *node;
+
+    if (dll_size(list) != dllu_size(unrolled))
+        return 0;
+
+    for (pos = dllu_head(unrolled), node = list->head; node; pos = dllu_next(pos), node = node->next)
+        if (!pos.node || dllu_data(pos) != node->data)
+            return 0;
+
+    for (pos = dllu_tail(unrolled), node = list->tail; node; pos = dllu_prev(pos), node = node->prev)
+        if (!pos.node || dllu_data(pos) != node->data)
+            return 0;
+
+    return 1;
+}
+
+/**
+ * Applies the same random inserts and deletes around searched positions
+ * to a list and an unrolled list, so dllu_addBefore and dllu_addAfter
+ * split full nodes and dllu_erase merges sparse ones, then compares them.
+ * Reverses, sorts and searches both from head and tail, and erases
+ * every third element while iterating, comparing after each step.
+ *
+ * @param unsigned long n: number of initial elements
+ * @param unsigned long ops: number of inserts and deletes
+ * @return void
+ */
+void benchUnrolledEdit(unsigned long n, unsigned long ops)
+{
+    int *keys = malloc((n + ops) * sizeof(int));
+    dll_t *list = dll_create();
+    dllu_t *unrolled = dllu_create();
+    dllu_pos_t pos;
+    dll_iter_t it;
+    dll_node_t *node;
+    unsigned long i, k, edits = 0;
+    short int same;
+
+    dll_registerFreeFn(list, freeFn);
+    dll_registerCompareFn(list, compareFn);
+    dllu_registerFreeFn(unrolled, freeFn);
+    dllu_registerCompareFn(unrolled, compareFn);
+
+    for (i = 0; i < n + ops; i++)
+        keys[i] = i;
+
+    for (i = 0; i < n; i++)
+    {
+        dll_pushTail(list, &keys[i]);
+        dllu_pushTail(unrolled, &keys[i]);
+    }
+
+    double start = now();
+
+    for (i = 0; i < ops; i++)
+    {
+        k = rand() % (n + i);
+        pos = dllu_search(unrolled, &keys[k], 1);
+        node = dll_search(list, &keys[k], 1);
+
+        if (!pos.node || !node)
+            continue;
+
+        edits++;
+
+        if (i % 3 == 0)
+        {
+            dllu_erase(unrolled, pos);
+            dll_searchAndDelete(list, &keys[k], 1);
+        }
+        else if (i % 3 == 1)
+        {
+            dllu_addBefore(unrolled, pos, &keys[n + i]);
+            dll_addBefore(list, node, &keys[n + i]);
+        }
+        else
+        {
+            dllu_addAfter(unrolled, pos, &keys[n + i]);
+            dll_addAfter(list, node, &keys[n + i]);
+        }
+    }
+
+    double elapsed = now() - start;
+
+    same = dll_size(list) == dllu_size(unrolled);
+
+    for (i = 0, node = dll_head(list); same && node; i++, node = node->next)
+        same = dllu_get(unrolled, i) == node->data;
+
+    dll_reverse(list);
+    dllu_reverse(unrolled);
+    same &= sameUnrolled(list, unrolled);
+
+    for (i = 0; i < 100; i++)
+    {
+        k = rand() % (n + ops);
+        pos = dllu_search(unrolled, &keys[k], 3);
+        node = dll_search(list, &keys[k], 3);
+        same &= (pos.node ? dllu_data(pos) : NULL) == (node ? node->data : NULL);
+    }
+
+    dll_sort(list);
+    same &= dllu_sort(unrolled) && sameUnrolled(list, unrolled);
+
+    for (i = 0, pos = dllu_head(unrolled), dll_iterHead(&it, list); pos.node && dll_iterValid(&it); i++)
+    {
+        if (i % 3)
+        {
+            pos = dllu_next(pos);
+            dll_iterNext(&it);
+        }
+        else
+        {
+            pos = dllu_erase(unrolled, pos);
+            dll_iterErase(&it);
+        }
+    }
+    same &= !pos.node && !dll_iterValid(&it) && sameUnrolled(list, unrolled);
+
+    puts("unrolled edit        nodes      edits     ms");
+
+    printf("                 %10lu %10lu %6.2f\n", dllu_size(unrolled), edits, elapsed * 1e3);
+
+    if (!same)
+        puts("ERROR: unrolled list differs from the list");
+
+    dll_clear(list);
+    dllu_clear(unrolled);
+    free(keys);
+}
+
+/**
+ * Returns a hash of the integer for the hash index.
+ *
+ * @param void *data: pointer to an int
+ * @return unsigned long: hash
+ */
+unsigned long hashValue(void *data)
+{
+    return *(int*)data * 2654435761u;
+}
+
+/**
+ * Checks the list against the expected integers: the order, dll_get
+ * and, with the hash index, a hash search for every 97th integer.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param int *expected: expected integers in list order
+ * @param unsigned long n: number of expected integers
+ * @return int: list as expected
+ */
+short int checkList(dll_t *list, int *expected, unsigned long n)
+{
+    dll_node_t *node;
+    unsigned long i;
+
+    if (dll_size(list) != n)
+        return 0;
+
+    for (i = 0, node = dll_head(list); node; i++, node = node->next)
+    {
+        if (*(int*)node->data != expected[i] || (node->next && node->next->prev != node))
+            return 0;
+    }
+
+    for (i = 0; i < n; i += 97)
+    {
+        if (*(int*)dll_get(list, i)->data != expected[i] || dll_indexOf(list, dll_get(list, i)) != i)
+            return 0;
+
+        if (!list->hash)
+            continue;
+
+        node = dll_search(list, &expected[i], 4);
+        if (!node || *(int*)node->data != expected[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Walks a list of n integers with an iterator from head to tail, erases
+ * the even integers and adds new integers before and after the odd ones,
+ * then erases the tail and inserts at the head and in the middle. Runs
+ * on a plain list and on a pooled list with the hash and the skip index.
+ *
+ * @param unsigned long n: number of elements, odd so the tail is even
+ * @return void
+ */
+void benchIterator(unsigned long n)
+{
+    int *values = malloc((3 * n + 2) * sizeof(int));
+    int *expected = malloc((3 * n + 2) * sizeof(int));
+    unsigned long i, count;
+    int indexed;
+
+    for (i = 0; i < 3 * n + 2; i++)
+        values[i] = i;
+
+    puts("iterator             nodes   indexes      edit ms");
+
+    for (indexed = 0; indexed < 2; indexed++)
+    {
+        dll_t *list = indexed ? dll_createWithPool(4096) : dll_create();
+        dll_iter_t it;
+        int v;
+
+        dll_registerFreeFn(list, freeFn);
+        dll_registerCompareFn(list, compareFn);
+
+        if (indexed)
+        {
+            dll_registerHashFn(list, hashValue);
+            dll_enableIndex(list);
+        }
+
+        for (i = 0; i < n; i++)
+            dll_pushTail(list, &values[i]);
+
+        double start = now();
+
+        /* the head 0 and the tail n - 1 are erased while iterating */
+        count = 0;
+        for (dll_iterHead(&it, list); dll_iterValid(&it); )
+        {
+            v = *(int*)dll_iterNode(&it)->data;
+
+            if (v % 2 == 0)
+            {
+                dll_iterErase(&it);
+                continue;
+            }
+
+            dll_iterInsertBefore(&it, &values[n + v]);
+            dll_iterInsertAfter(&it, &values[2 * n + v]);
+            expected[count++] = n + v;
+            expected[count++] = v;
+            expected[count++] = 2 * n + v;
+
+            dll_iterNext(&it);
+            dll_iterNext(&it);
+        }
+
+        dll_iterTail(&it, list);
+        dll_iterErase(&it);
+        count--;
+
+        dll_iterAt(&it, list, 0);
+        dll_iterInsertBefore(&it, &values[3 * n]);
+        memmove(expected + 1, expected, count++ * sizeof(int));
+        expected[0] = 3 * n;
+
+        dll_iterAt(&it, list, count / 2);
+        dll_iterInsertAfter(&it, &values[3 * n + 1]);
+        memmove(expected + count / 2 + 2, expected + count / 2 + 1, (count - count / 2 - 1) * sizeof(int));
+        expected[count / 2 + 1] = 3 * n + 1;
+        count++;
+
+        double elapsed = now() - start;
+
+        printf("                 %10lu   %7s     %8.2f\n", dll_size(list), indexed ? "yes" : "no", elapsed * 1e3);
+
+        if (!checkList(list, expected, count))
+            puts("ERROR: iterator edits differ from the expected list");
+
+        dll_clear(list);
+    }
+
+    free(expected);
+    free(values);
+}
+
+/**
+ * Moves count integers from the index from of an array to the index at
+ * of another array, like dll_splice does with the nodes.
+ *
+ * @param int *src: source array
+ * @param unsigned long *srcCount: number of integers of src
+ * @param unsigned long from: index of the first moved integer
+ * @param unsigned long count: number of moved integers
+ * @param int *dst: destination array
+ * @param unsigned long *dstCount: number of integers of dst
+ * @param unsigned long at: index of dst to insert at
+ * @return void
+ */
+void moveRange(int *src, unsigned long *srcCount, unsigned long from, unsigned long count,
+               int *dst, unsigned long *dstCount, unsigned long at)
+{
+    memmove(dst + at + count, dst + at, (*dstCount - at) * sizeof(int));
+    memcpy(dst + at, src + from, count * sizeof(int));
+    *dstCount += count;
+
+    memmove(src + from, src + from + count, (*srcCount - from - count) * sizeof(int));
+    *srcCount -= count;
+}
+
+/**
+ * Runs the file and layout commands of testCommands.txt on a pooled
+ * list and checks the results, which the interactive script only
+ * prints: integers from n - 1 down to 0 and -1 before 0 are sorted by
+ * dll_sortByIntKey, written as a snapshot and mapped, saved, cleared
+ * and loaded again and finally compacted.
+ *
+ * @param unsigned long n: number of integers besides -1
+ * @return void
+ */
+void checkCommands(unsigned long n)
+{
+    const char *binary = "check.dll", *snapshot = "check.snap";
+    int *expected = malloc((n + 1) * sizeof(int));
+    dll_t *list = dll_createWithPool(64);
+    dlls_t *snap = NULL;
+    dlls_node_t *mapped;
+    dll_node_t *node;
+    unsigned long i;
+    short int ok = 1;
+
+    dll_registerFreeFn(list, freeData);
+    dll_registerSerializeFn(list, serializeInt);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    for (i = 0; i <= n; i++)
+    {
+        int *data = malloc(sizeof(int));
+        *data = (int)n - 1 - (int)i;
+        dll_pushTail(list, data);
+        expected[i] = (int)i - 1;
+    }
+
+    ok &= dll_sortByIntKey(list, 0, DLL_KEY_I32) && checkList(list, expected, n + 1);
+
+    ok &= dlls_write(list, snapshot, sizeof(int)) && (snap = dlls_open(snapshot));
+    if (ok)
+    {
+        for (mapped = dlls_head(snap), node = list->head; mapped && node; mapped = dlls_next(mapped), node = node->next)
+            ok &= *(int*)dlls_data(mapped) == *(int*)node->data;
+        ok &= !mapped && !node && dlls_size(snap) == n + 1;
+        dlls_close(snap);
+    }
+
+    ok &= dll_save(list, binary);
+    dll_clear(list);
+
+    list = dll_createWithPool(64);
+    dll_registerFreeFn(list, freeData);
+    dll_registerDeserializeFn(list, deserializeInt);
+
+    /* shuffle the free list of the pool, so the loaded nodes are scattered */
+    for (i = 0; i <= n; i++)
+        dll_pushTail(list, malloc(sizeof(int)));
+    dll_sortByKey(list, randomKey);
+    while (dll_size(list))
+        dll_popHead(list);
+
+    ok &= dll_load(list, binary) && checkList(list, expected, n + 1);
+
+    for (i = 0, node = list->head; node && node->next; node = node->next)
+        i += node->next != node + 1;
+
+    ok &= i > 0 && dll_compact(list) && checkList(list, expected, n + 1);
+
+    for (node = list->head; node && node->next; node = node->next)
+        ok &= node->next == node + 1;
+
+    puts("check commands       nodes");
+
+    printf("                 %10lu\n", n + 1);
+
+    if (!ok)
+        puts("ERROR: the commands of testCommands.txt give wrong results");
+
+    dll_clear(list);
+    free(expected);
+    remove(binary);
+    remove(snapshot);
+}
+
+/**
+ * Moves nodes between two pooled lists of n integers each, with the
+ * hash and the skip index: a middle range with dll_splice before a node
+ * and to the tail, dll_splitAt at 0, in the middle and at the size,
+ * also during an incremental compaction, and dll_concat. After every
+ * step the lists are compared with arrays moved the same way, and a
+ * moved node is checked with dll_contains and dll_indexOf.
+ *
+ * @param unsigned long n: number of elements per list, at least 64
+ * @return void
+ */
+void benchSplice(unsigned long n)
+{
+    int *values = malloc(2 * n * sizeof(int));
+    int *model[3];
+    unsigned long count[3] = {n, n, 0}, i;
+    dll_t *list[3];
+    dll_node_t *node;
+    double elapsed[2];
+    short int ok = 1;
+
+    for (i = 0; i < 3; i++)
+        model[i] = malloc(2 * n * sizeof(int));
+
+    list[0] = dll_createWithPool(4096);
+    list[1] = dll_createSharingPool(list[0]);
+
+    for (i = 0; i < 2; i++)
+    {
+        dll_registerFreeFn(list[i], freeFn);
+        dll_registerCompareFn(list[i], compareFn);
+        dll_registerHashFn(list[i], hashValue);
+        dll_enableIndex(list[i]);
+    }
+
+    for (i = 0; i < 2 * n; i++)
+    {
+        values[i] = i;
+        model[i / n][i % n] = i;
+        dll_pushTail(list[i / n], &values[i]);
+    }
+
+    /* a middle range of the first list before the middle of the second */
+    node = dll_get(list[0], n / 4);
+    dll_splice(list[1], dll_get(list[1], n / 2), list[0], node, dll_get(list[0], n / 2 - 1));
+    moveRange(model[0], &count[0], n / 4, n / 4, model[1], &count[1], n / 2);
+    ok &= dll_contains(list[1], node) && !dll_contains(list[0], node) && dll_indexOf(list[1], node) == n / 2;
+    ok &= checkList(list[0], model[0], count[0]) && checkList(list[1], model[1], count[1]);
+
+    /* the head of the second list to the tail of the first, pos NULL */
+    node = dll_head(list[1]);
+    dll_splice(list[0], NULL, list[1], node, dll_get(list[1], 9));
+    moveRange(model[1], &count[1], 0, 10, model[0], &count[0], count[0]);
+    ok &= dll_contains(list[0], node) && dll_indexOf(list[0], node) == count[0] - 10;
+    ok &= checkList(list[0], model[0], count[0]) && checkList(list[1], model[1], count[1]);
+
+    /* split off the nodes ahead of an incremental compaction */
+    dll_compactStep(list[0], 16);
+    list[2] = dll_splitAt(list[0], 8);
+    moveRange(model[0], &count[0], 8, count[0] - 8, model[2], &count[2], 0);
+    while (dll_compactStep(list[0], 16))
+        ;
+    ok &= list[2] && checkList(list[0], model[0], count[0]) && checkList(list[2], model[2], count[2]);
+
+    /* concat with the hash and the skip index */
+    node = dll_head(list[2]);
+    elapsed[0] = now();
+    ok &= dll_concat(list[0], list[2]);
+    elapsed[0] = now() - elapsed[0];
+    moveRange(model[2], &count[2], 0, count[2], model[0], &count[0], count[0]);
+    ok &= dll_contains(list[0], node) && dll_indexOf(list[0], node) == 8 && !dll_size(list[2]);
+    ok &= checkList(list[0], model[0], count[0]);
+    dll_clear(list[2]);
+
+    /* split at 0 moves everything, at the size nothing */
+    elapsed[1] = now();
+    list[2] = dll_splitAt(list[1], 0);
+    elapsed[1] = now() - elapsed[1];
+    moveRange(model[1], &count[1], 0, count[1], model[2], &count[2], 0);
+    ok &= list[2] && !dll_size(list[1]) && checkList(list[2], model[2], count[2]);
+    dll_clear(list[1]);
+
+    list[1] = dll_splitAt(list[2], dll_size(list[2]));
+    ok &= list[1] && !dll_size(list[1]) && checkList(list[2], model[2], count[2]);
+
+    puts("splice               nodes    concat ms   splitAt(0) ms");
+
+    printf("                 %10lu     %8.2f        %8.2f\n",
+           count[0] + count[2], elapsed[0] * 1e3, elapsed[1] * 1e3);
+
+    if (!ok)
+        puts("ERROR: moved nodes differ from the expected lists");
+
+    for (i = 0; i < 3; i++)
+    {
+        dll_clear(list[i]);
+        free(model[i]);
+    }
+    free(values);
+}
+
+/**
+ * State of a worker thread of the concurrent benchmark.
+ */
+typedef struct
+{
+    dllc_t *list;
+    dll_t *plain;
+    pthread_mutex_t *lock;
+    unsigned long id;
+    unsigned long ops;
+    unsigned long long pushed;
+    unsigned long long popped;
+} worker_t;
+
+/**
+ * Pushs and pops unique values at alternating ends of the concurrent list
+ * and sums them up, so the main thread can verify no value got lost.
+ *
+ * @param void *arg: worker state
+ * @return void*: NULL
+ */
+void* concurrentWorker(void *arg)
+{
+    worker_t *w = arg;
+    unsigned long i;
+    uintptr_t v;
+
+    for (i = 0; i < w->ops; i++)
+    {
+        v = w->id * w->ops + i + 1;
+
+        if ((i ^ w->id) & 1)
+            dllc_pushHead(w->list, (void *) v);
+        else
+            dllc_pushTail(w->list, (void *) v);
+        w->pushed += v;
+
+        if ((i >> 1 ^ w->id) & 1)
+            v = (uintptr_t) dllc_popHead(w->list);
+        else
+            v = (uintptr_t) dllc_popTail(w->list);
+        w->popped += v;
+    }
+
+    return NULL;
+}
+
+/**
+ * Runs the same workload on a dll_t wrapped in a single mutex.
+ *
+ * @param void *arg: worker state
+ * @return void*: NULL
+ */
+void* mutexWorker(void *arg)
+{
+    worker_t *w = arg;
+    unsigned long i;
+
+    for (i = 0; i < w->ops; i++)
+    {
+        pthread_mutex_lock(w->lock);
+        if ((i ^ w->id) & 1)
+            dll_pushHead(w->plain, &value);
+        else
+            dll_pushTail(w->plain, &value);
+        pthread_mutex_unlock(w->lock);
+
+        pthread_mutex_lock(w->lock);
+        if ((i >> 1 ^ w->id) & 1)
+            dll_popHead(w->plain);
+        else
+            dll_popTail(w->plain);
+        pthread_mutex_unlock(w->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Stress tests the concurrent list and compares its scaling with a
+ * mutex wrapped dll_t from 1 to maxThreads threads.
+ *
+ * @param unsigned long ops: number of push/pop pairs per thread
+ * @param unsigned long maxThreads: maximum number of threads
+ * @return void
+ */
+void benchConcurrent(unsigned long ops, unsigned long maxThreads)
+{
+    pthread_t tid[maxThreads];
+    worker_t w[maxThreads];
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    unsigned long threads, i;
+
+    puts("concurrent push/pop  threads    mutex Mops/s    dllc Mops/s");
+
+    for (threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        dllc_t *list = dllc_create();
+        dll_t *plain = dll_create();
+        unsigned long long pushed = 0, popped = 0;
+        double m, c;
+        void *data;
+
+        dll_registerFreeFn(plain, freeFn);
+
+        /* keep the ends apart, so both sides can work in parallel */
+        for (i = 0; i < 1000; i++)
+        {
+            dllc_pushTail(list, (void *) ~(uintptr_t) i);
+            dll_pushTail(plain, &value);
+            pushed += ~(uintptr_t) i;
+        }
+
+        for (i = 0; i < threads; i++)
+        {
+            w[i] = (worker_t) { list, plain, &lock, i, ops, 0, 0 };
+            pthread_create(&tid[i], NULL, mutexWorker, &w[i]);
+        }
+        m = now();
+        for (i = 0; i < threads; i++)
+            pthread_join(tid[i], NULL);
+        m = now() - m;
+
+        c = now();
+        for (i = 0; i < threads; i++)
+            pthread_create(&tid[i], NULL, concurrentWorker, &w[i]);
+        for (i = 0; i < threads; i++)
+        {
+            pthread_join(tid[i], NULL);
+            pushed += w[i].pushed;
+            popped += w[i].popped;
+        }
+        c = now() - c;
+
+        while ((data = dllc_popHead(list)))
+            popped += (uintptr_t) data;
+
+        if (pushed != popped)
+            printf("ERROR: pushed sum %llu != popped sum %llu\n", pushed, popped);
+
+        printf("                 %10lu    %12.2f    %11.2f\n",
+               threads, 2.0 * threads * ops / m / 1e6, 2.0 * threads * ops / c / 1e6);
+
+        dllc_clear(list);
+        dll_clear(plain);
+    }
+}
+
+/**
+ * State of a producer or consumer thread of the work queue benchmark.
+ */
+typedef struct
+{
+    dllf_t *queue;
+    dllc_t *list;
+    unsigned long id;
+    unsigned long ops;
+    unsigned long producers;
+    atomic_ulong *consumed;
+    unsigned long long sum;
+    unsigned long errors;
+} queueWorker_t;
+
+/**
+ * Pushs ops values tagged with the producer id and a sequence number.
+ *
+ * @param void *arg: worker state
+ * @return void*: NULL
+ */
+void* producer(void *arg)
+{
+    queueWorker_t *w = arg;
+    unsigned long i;
+    uintptr_t v;
+
+    for (i = 1; i <= w->ops; i++)
+    {
+        v = (uintptr_t) w->id << 32 | i;
+        if (w->queue)
+            dllf_pushTail(w->queue, (void *) v);
+        else
+            dllc_pushTail(w->list, (void *) v);
+        w->sum += v;
+    }
+
+    if (w->queue)
+        dllf_threadExit();
+
+    return NULL;
+}
+
+/**
+ * Pops values until all producers are drained. The sequence numbers of
+ * every producer must appear in increasing order (FIFO per producer).
+ *
+ * @param void *arg: worker state
+ * @return void*: NULL
+ */
+void* consumer(void *arg)
+{
+    queueWorker_t *w = arg;
+    unsigned long last[w->producers], total = w->producers * w->ops;
+    uintptr_t v;
+
+    for (v = 0; v < w->producers; v++)
+        last[v] = 0;
+
+    while (atomic_load(w->consumed) < total)
+    {
+        if (w->queue)
+            v = (uintptr_t) dllf_popHead(w->queue);
+        else
+            v = (uintptr_t) dllc_popHead(w->list);
+
+        if (!v)
+            continue;
+
+        if ((v & 0xffffffff) <= last[v >> 32])
+            w->errors++;
+        last[v >> 32] = v & 0xffffffff;
+        w->sum += v;
+        atomic_fetch_add(w->consumed, 1);
+    }
+
+    if (w->queue)
+        dllf_threadExit();
+
+    return NULL;
+}
+
+/**
+ * Runs producers and consumers on a work queue and checks that every
+ * value is popped exactly once and in order per producer.
+ *
+ * @param dllf_t *queue: lock-free queue, or NULL
+ * @param dllc_t *list: concurrent list used if queue is NULL
+ * @param unsigned long ops: number of values per producer
+ * @param unsigned long threads: number of threads, half of them producers
+ * @return double: elapsed seconds
+ */
+double workQueue(dllf_t *queue, dllc_t *list, unsigned long ops, unsigned long threads)
+{
+    unsigned long producers = threads > 1 ? threads / 2 : 1;
+    unsigned long consumers = threads > 1 ? threads - producers : 1;
+    pthread_t tid[producers + consumers];
+    queueWorker_t w[producers + consumers];
+    atomic_ulong consumed = 0;
+    unsigned long long pushed = 0, popped = 0;
+    unsigned long i, errors = 0;
+
+    double start = now();
+
+    for (i = 0; i < producers + consumers; i++)
+    {
+        w[i] = (queueWorker_t) { queue, list, i, ops, producers, &consumed, 0, 0 };
+        pthread_create(&tid[i], NULL, i < producers ? producer : consumer, &w[i]);
+    }
+
+    for (i = 0; i < producers + consumers; i++)
+    {
+        pthread_join(tid[i], NULL);
+        if (i < producers)
+            pushed += w[i].sum;
+        else
+            popped += w[i].sum;
+        errors += w[i].errors;
+    }
+
+    double elapsed = now() - start;
+
+    if (pushed != popped || errors)
+        printf("ERROR: pushed sum %llu, popped sum %llu, %lu out of order\n", pushed, popped, errors);
+
+    return elapsed;
+}
+
+/**
+ * Compares the lock-free queue with the concurrent list used as
+ * work queue (dll_pushTail and dll_popHead) from 2 to maxThreads threads.
+ *
+ * @param unsigned long ops: number of values per producer
+ * @param unsigned long maxThreads: maximum number of threads
+ * @return void
+ */
+void benchLockFree(unsigned long ops, unsigned long maxThreads)
+{
+    unsigned long threads;
+
+    puts("work queue           threads     dllc Mops/s    dllf Mops/s");
+
+    for (threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        unsigned long total = threads / 2 * ops;
+        dllc_t *list = dllc_create();
+        dllf_t *queue = dllf_create();
+
+        double c = workQueue(NULL, list, ops, threads);
+        double f = workQueue(queue, NULL, ops, threads);
+
+        printf("                 %10lu    %12.2f    %11.2f\n",
+               threads, 2.0 * total / c / 1e6, 2.0 * total / f / 1e6);
+
+        dllc_clear(list);
+        dllf_clear(queue);
+    }
+
+    dllf_cleanup();
+}
+
+int main(int argc, char const *argv[])
+{
+    unsigned long ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    benchPool(ops);
+    benchBulk(ops / 10);
+    benchClear(ops / 10);
+    benchSort(ops / 10, cores > 32 ? 32 : cores > 1 ? cores : 2);
+    benchParallel(ops / 10, cores > 32 ? 32 : cores > 1 ? cores : 2);
+    benchTopK(ops / 10);
+    benchSorted(ops / 100, 1000);
+    benchSortByKey(ops / 10);
+    benchLoad(ops / 10);
+    benchSnapshot(ops / 10);
+    benchSnapshotSearch(ops / 10, 100000);
+    benchStream(ops / 10, 65536);
+    benchCompact(ops / 10, 4096);
+    benchUnrolled(ops / 10, 10000);
+    benchUnrolledEdit(10000, 5000);
+    benchIterator(ops / 100 + 1);
+    checkCommands(ops / 1000);
+    benchSplice(ops / 100);
+    benchConcurrent(ops / 10, cores > 1 ? cores : 2);
+    benchLockFree(ops / 10, cores > 1 ? cores : 2);
+
+    return 0;
+}
@@ -0,0 +1,607 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ *  @file   benchsuite.c
+ *  @author Marc Zimmermann (tooreht@gmail.com)
+ *  @date   December, 2012
+ *  @brief  Benchmark suite of doublyLinkedList.
+ *
+ *  This programm measures the basic list operations for list sizes from
+ *  10 up to a maximum size (default 10^6) in powers of ten. Every
+ *  measurement runs once for warmup and then repeatedly. The suite reports
+ *  the mean time per operation, the throughput and percentiles of the
+ *  repetitions. With -csv it prints one CSV line per measurement instead,
+ *  so runs of different versions can be compared.
+ *
+ *  usage: benchsuite [-csv] [maxSize]
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dll.h"
+
+#define MAX_REPS 50
+#define MAX_QUERIES 1000
+
+/**
+ * A benchmarked operation: run sets up a list of n elements, measures
+ * the operation and returns the elapsed seconds and the number of
+ * operations done.
+ */
+typedef struct
+{
+    const char *name;
+    double (*run)(unsigned long n, unsigned long *ops);
+} operation_t;
+
+int *values;
+void **items;
+void **shuffled;
+unsigned long *indexes;
+
+/**
+ * Returns the current time in seconds.
+ *
+ * @param void
+ * @return double: seconds
+ */
+double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * The data is not owned by the list, so nothing has to be freed.
+ *
+ * @param void* data
+ * @return void
+ */
+void freeFn(void *data)
+{
+}
+
+/**
+ * Does nothing with the data, for dll_traverse.
+ *
+ * @param void* data
+ * @return void
+ */
+void visitFn(void *data)
+{
+}
+
+/**
+ * Compares the integers pointed to by a and b.
+ *
+ * @param void *a: pointer to an int
+ * @param void *b: pointer to an int
+ * @return int: <0, 0 or >0
+ */
+int compareFn(void *a, void *b)
+{
+    int x = *(int*)a, y = *(int*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Hashes the integer pointed to by data.
+ *
+ * @param void *data: pointer to an int
+ * @return unsigned long: hash
+ */
+unsigned long hashFn(void *data)
+{
+    return (unsigned int) *(int*)data * 2654435761UL;
+}
+
+/**
+ * Returns the number of queries for operations which take O(n).
+ *
+ * @param unsigned long n: number of elements
+ * @return unsigned long: number of queries
+ */
+unsigned long queries(unsigned long n)
+{
+    unsigned long q = 10000000 / n;
+
+    return q < 10 ? 10 : q > MAX_QUERIES ? MAX_QUERIES : q;
+}
+
+/**
+ * Creates a list of the integers 0 to n - 1 in order or shuffled.
+ *
+ * @param unsigned long n: number of elements
+ * @param int shuffle: use the shuffled order
+ * @return dll_t*: pointer of the new list
+ */
+dll_t* build(unsigned long n, int shuffle)
+{
+    dll_t *list = dll_create();
+
+    dll_registerFreeFn(list, freeFn);
+    dll_registerCompareFn(list, compareFn);
+    dll_pushTailBulk(list, shuffle ? shuffled : items, n);
+
+    return list;
+}
+
+/**
+ * Measures n dll_pushHead calls on an empty list.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double pushHead(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = dll_create();
+    unsigned long i;
+
+    dll_registerFreeFn(list, freeFn);
+
+    double start = now();
+    for (i = 0; i < n; i++)
+        dll_pushHead(list, items[i]);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = n;
+
+    return elapsed;
+}
+
+/**
+ * Measures n dll_pushTail calls on an empty list.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double pushTail(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = dll_create();
+    unsigned long i;
+
+    dll_registerFreeFn(list, freeFn);
+
+    double start = now();
+    for (i = 0; i < n; i++)
+        dll_pushTail(list, items[i]);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = n;
+
+    return elapsed;
+}
+
+/**
+ * Measures n dll_popHead calls on a list of n elements.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double popHead(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = build(n, 0);
+    unsigned long i;
+
+    double start = now();
+    for (i = 0; i < n; i++)
+        dll_popHead(list);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = n;
+
+    return elapsed;
+}
+
+/**
+ * Measures n dll_popTail calls on a list of n elements.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double popTail(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = build(n, 0);
+    unsigned long i;
+
+    double start = now();
+    for (i = 0; i < n; i++)
+        dll_popTail(list);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = n;
+
+    return elapsed;
+}
+
+/**
+ * Gets queries random indexes, with or without the skip index.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @param int indexed: enable the skip index
+ * @return double: elapsed seconds
+ */
+double getAt(unsigned long n, unsigned long *ops, int indexed)
+{
+    dll_t *list = build(n, 0);
+    unsigned long i, q = indexed ? MAX_QUERIES : queries(n);
+
+    if (indexed)
+        dll_enableIndex(list);
+
+    double start = now();
+    for (i = 0; i < q; i++)
+        dll_get(list, indexes[i] % n);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = q;
+
+    return elapsed;
+}
+
+/**
+ * Measures dll_get without the skip index.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double get(unsigned long n, unsigned long *ops)
+{
+    return getAt(n, ops, 0);
+}
+
+/**
+ * Measures dll_get with the skip index.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double getIndexed(unsigned long n, unsigned long *ops)
+{
+    return getAt(n, ops, 1);
+}
+
+/**
+ * Searches random values of the list with a search mode.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @param short int mode: search mode of dll_search
+ * @return double: elapsed seconds
+ */
+double search(unsigned long n, unsigned long *ops, short int mode)
+{
+    dll_t *list = build(n, 0);
+    unsigned long i, q = mode == 4 ? MAX_QUERIES : queries(n);
+
+    if (mode == 4)
+        dll_registerHashFn(list, hashFn);
+
+    double start = now();
+    for (i = 0; i < q; i++)
+        dll_search(list, items[indexes[i] % n], mode);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = q;
+
+    return elapsed;
+}
+
+/**
+ * Measures dll_search from head to tail.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double search1(unsigned long n, unsigned long *ops)
+{
+    return search(n, ops, 1);
+}
+
+/**
+ * Measures dll_search from tail to head.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double search2(unsigned long n, unsigned long *ops)
+{
+    return search(n, ops, 2);
+}
+
+/**
+ * Measures dll_search from head and tail.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double search3(unsigned long n, unsigned long *ops)
+{
+    return search(n, ops, 3);
+}
+
+/**
+ * Measures dll_search with the hash index.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double search4(unsigned long n, unsigned long *ops)
+{
+    return search(n, ops, 4);
+}
+
+/**
+ * Measures dll_sort of a shuffled list, per element.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double sort(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = build(n, 1);
+
+    double start = now();
+    dll_sort(list);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = n;
+
+    return elapsed;
+}
+
+/**
+ * Measures dll_reverse, per element.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double reverse(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = build(n, 0);
+
+    double start = now();
+    dll_reverse(list);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = n;
+
+    return elapsed;
+}
+
+/**
+ * Measures dll_traverse, per element.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double traverse(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = build(n, 0);
+
+    double start = now();
+    dll_traverse(list, visitFn);
+    double elapsed = now() - start;
+
+    dll_clear(list);
+    *ops = n;
+
+    return elapsed;
+}
+
+/**
+ * Measures dll_clear, per element.
+ *
+ * @param unsigned long n: number of elements
+ * @param unsigned long *ops: number of operations
+ * @return double: elapsed seconds
+ */
+double clear(unsigned long n, unsigned long *ops)
+{
+    dll_t *list = build(n, 0);
+
+    double start = now();
+    dll_clear(list);
+    double elapsed = now() - start;
+
+    *ops = n;
+
+    return elapsed;
+}
+
+operation_t operations[] =
+{
+    { "pushHead", pushHead },
+    { "pushTail", pushTail },
+    { "popHead", popHead },
+    { "popTail", popTail },
+    { "get", get },
+    { "get/index", getIndexed },
+    { "search/1", search1 },
+    { "search/2", search2 },
+    { "search/3", search3 },
+    { "search/4", search4 },
+    { "sort", sort },
+    { "reverse", reverse },
+    { "traverse", traverse },
+    { "clear", clear },
+};
+
+/**
+ * Compares two doubles for qsort.
+ *
+ * @param const void *a: pointer to a double
+ * @param const void *b: pointer to a double
+ * @return int: <0, 0 or >0
+ */
+int compareDouble(const void *a, const void *b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Returns the percentile of sorted samples (nearest rank).
+ *
+ * @param double *samples: sorted samples
+ * @param int count: number of samples
+ * @param int percent: percentile
+ * @return double: sample
+ */
+double percentile(double *samples, int count, int percent)
+{
+    int rank = (percent * count + 99) / 100;
+
+    return samples[rank > 0 ? rank - 1 : 0];
+}
+
+/**
+ * Measures an operation with a list size: one warmup run and then
+ * repetitions, fewer for bigger lists.
+ *
+ * @param operation_t *op: operation
+ * @param unsigned long n: number of elements
+ * @param int csv: print CSV
+ * @return void
+ */
+void measure(operation_t *op, unsigned long n, int csv)
+{
+    double samples[MAX_REPS], elapsed, total = 0;
+    unsigned long ops, totalOps = 0;
+    int reps = 10000000 / n, r;
+
+    reps = reps < 5 ? 5 : reps > MAX_REPS ? MAX_REPS : reps;
+
+    op->run(n, &ops);
+
+    for (r = 0; r < reps; r++)
+    {
+        elapsed = op->run(n, &ops);
+        samples[r] = elapsed * 1e9 / ops;
+        total += elapsed;
+        totalOps += ops;
+    }
+
+    qsort(samples, reps, sizeof(double), compareDouble);
+
+    double mean = total * 1e9 / totalOps;
+
+    if (csv)
+        printf("%s,%lu,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", op->name, n, reps, mean,
+               1e3 / mean, samples[0], percentile(samples, reps, 50),
+               percentile(samples, reps, 90), percentile(samples, reps, 99));
+    else
+        printf("%-10s %10lu %5d %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", op->name, n, reps,
+               mean, 1e3 / mean, samples[0], percentile(samples, reps, 50),
+               percentile(samples, reps, 90), percentile(samples, reps, 99));
+
+    fflush(stdout);
+}
+
+int main(int argc, char const *argv[])
+{
+    unsigned long maxSize = 1000000, n, i;
+    unsigned int o;
+    int csv = 0, a;
+
+    for (a = 1; a < argc; a++)
+    {
+        if (!strcmp(argv[a], "-csv"))
+            csv = 1;
+        else
+            maxSize = strtoul(argv[a], NULL, 10);
+    }
+
+    values = malloc(maxSize * sizeof(int));
+    items = malloc(maxSize * sizeof(void*));
+    shuffled = malloc(maxSize * sizeof(void*));
+    indexes = malloc(MAX_QUERIES * sizeof(unsigned long));
+
+    if (!values || !items || !shuffled || !indexes)
+    {
+        puts("ERROR: Out of memory");
+        return 1;
+    }
+
+    /* fixed seed, so every run measures the same work */
+    srand(42);
+
+    for (i = 0; i < maxSize; i++)
+    {
+        values[i] = i;
+        items[i] = shuffled[i] = &values[i];
+    }
+
+    for (i = maxSize; i > 1; i--)
+    {
+        unsigned long j = ((unsigned long)rand() * RAND_MAX + rand()) % i;
+        void *swap = shuffled[i - 1];
+        shuffled[i - 1] = shuffled[j];
+        shuffled[j] = swap;
+    }
+
+    for (i = 0; i < MAX_QUERIES; i++)
+        indexes[i] = (unsigned long)rand() * RAND_MAX + rand();
+
+    if (csv)
+        puts("operation,size,reps,ns_per_op,mops_per_s,min_ns,p50_ns,p90_ns,p99_ns");
+    else
+        printf("%-10s %10s %5s %10s %10s %10s %10s %10s %10s\n", "operation", "size", "reps",
+               "ns/op", "Mops/s", "min ns", "p50 ns", "p90 ns", "p99 ns");
+
+    for (o = 0; o < sizeof(operations) / sizeof(operations[0]); o++)
+        for (n = 10; n <= maxSize; n *= 10)
+            measure(&operations[o], n, csv);
+
+    free(values);
+    free(items);
+    free(shuffled);
+    free(indexes);
+
+    return 0;
+}
@@ -26,18 +26,287 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
 /* uncomment to ignore the assertions (no debug) */
 // #define NDEBUG
 #include <assert.h>
+/* uncomment to validate dll_contains by walking the list (debug) */
+// #define DLL_VALIDATE
 
 #include "dll.h"
 
+/**
+ * Statistics: with DLL_STATS the operations of every list are counted
+ * in list->stats, without they compile to nothing. compareFn calls are
+ * counted atomically, as dll_sortParallel compares in several threads.
+ */
+#ifdef DLL_STATS
+#define DLL_STAT(list, counter, n) ((list)->stats.counter += (n))
+#define DLL_COMPARE(list, a, b) \
+    (__atomic_fetch_add(&(list)->stats.compares, 1, __ATOMIC_RELAXED), (list)->compareFn(a, b))
+#define DLL_TIMER(start) clock_gettime(CLOCK_MONOTONIC, &(start))
+#define DLL_LATENCY(list, histogram, start) dll_statsRecord((list)->stats.histogram, &(start))
+#else
+#define DLL_STAT(list, counter, n) ((void)0)
+#define DLL_COMPARE(list, a, b) ((list)->compareFn(a, b))
+#define DLL_TIMER(start) ((void)0)
+#define DLL_LATENCY(list, histogram, start) ((void)0)
+#endif
+
+/**
+ * Node pool: nodes are carved from chunks of chunkNodes nodes.
+ * Freed nodes are kept in a free list (linked through next) for reuse,
+ * the chunks are only released as a whole when the last list using
+ * the pool is cleared.
+ */
+typedef struct dll_chunk
+{
+    struct dll_chunk *next;
+    dll_node_t nodes[];
+} dll_chunk_t;
+
+typedef struct dll_pool
+{
+    dll_node_t *free;
+    dll_chunk_t *chunks;
+    dll_node_t *unused;
+    unsigned long left;
+    unsigned long chunkNodes;
+    unsigned long refs;
+} dll_pool_t;
+
+/**
+ * Hash index: open addressing table with linear probing, mapping the data
+ * of every node to the node. The capacity is a power of two and the table
+ * is kept at most half full.
+ */
+typedef struct dll_hashEntry
+{
+    unsigned long hash;
+    dll_node_t *node;
+} dll_hashEntry_t;
+
+typedef struct dll_hash
+{
+    dll_hashEntry_t *slots;
+    unsigned long capacity;
+    unsigned long used;
+} dll_hash_t;
+
+/**
+ * Skip index: an indexable skip list layered over the nodes.
+ * A node with a tower takes part in the levels 1..height, about one node
+ * in four gets a tower. On every level the towers are doubly linked, the
+ * head tower (index) precedes all nodes at position -1 and its prev links
+ * point to the last tower of each level. The width of a link is the
+ * distance in nodes to the next tower, or to position size for the last.
+ */
+#define DLL_SKIP_LEVELS 16
+
+/**
+ * File format of dll_save: the magic DLL_MAGIC and the number of
+ * elements as uint64_t, then per element its length as uint32_t and
+ * the bytes written by serializeFn, all in native byte order.
+ * Files are read and written through buffers of DLL_IO_BUFFER bytes,
+ * dll_load links the nodes in batches of DLL_LOAD_BATCH elements.
+ */
+#define DLL_MAGIC "DLL1"
+#define DLL_IO_BUFFER (1 << 20)
+#define DLL_LOAD_BATCH 4096
+
+typedef struct dll_skipLink
+{
+    struct dll_skip *prev;
+    struct dll_skip *next;
+    unsigned long width;
+} dll_skipLink_t;
+
+typedef struct dll_skip
+{
+    dll_node_t *node;
+    unsigned int height;
+    dll_skipLink_t link[];
+} dll_skip_t;
+
+/**
+ * Compaction: the nodes are moved in list order into the nodes of a new
+ * chunk, which belongs to the pool of the list. cursor is the next node
+ * to move, it is advanced when the node is deleted or spliced away
+ * between two steps.
+ */
+typedef struct dll_compact
+{
+    dll_node_t *nodes;
+    unsigned long used;
+    unsigned long capacity;
+    dll_node_t *cursor;
+} dll_compact_t;
+
+/**
+ * Reclaimer: lists handed to dll_clearDeferred are queued and cleared by
+ * a background thread, which is started on first use. pending counts the
+ * queued lists and the one being cleared.
+ */
+typedef struct dll_retired
+{
+    struct dll_retired *next;
+    dll_t *list;
+} dll_retired_t;
+
+/**
+ * Parallel sort: the list is cut into runs, which are sorted and then
+ * merged pairwise by separate threads. Lists shorter than
+ * DLL_SORT_GRAIN nodes per thread are sorted by fewer threads.
+ */
+#define DLL_SORT_GRAIN 8192
+
+typedef struct dll_sortRun
+{
+    dll_t *list;
+    dll_node_t *head;
+    dll_node_t *tail;
+    struct dll_sortRun *other;
+} dll_sortRun_t;
+
+/**
+ * Key sort: the keys of all nodes are extracted once into an array
+ * together with the node, the array is radix sorted and the nodes are
+ * relinked in its order. The top-k selection keeps the position of the
+ * node as key instead, to break ties.
+ */
+typedef struct dll_keyed
+{
+    unsigned long long key;
+    dll_node_t *node;
+} dll_keyed_t;
+
+/**
+ * Parallel traversal: the list is cut into one segment per thread, which
+ * is walked by its own thread. A segment calls either callback, mapFn
+ * into items or reduceFn into acc. Lists shorter than DLL_PARALLEL_GRAIN
+ * nodes per thread are processed by fewer threads, at most
+ * DLL_PARALLEL_THREADS threads are used. The segments are walked by the
+ * calling thread and a pool of worker threads, which are started on
+ * first use and kept waiting for the next call.
+ */
+#define DLL_PARALLEL_GRAIN 1024
+#define DLL_PARALLEL_THREADS 64
+
+typedef struct dll_segment
+{
+    dll_node_t *first;
+    unsigned long count;
+    void (*callback)(void*);
+    void* (*mapFn)(void*);
+    void* (*reduceFn)(void*, void*);
+    void **items;
+    void *acc;
+} dll_segment_t;
+
+/**
+ * Streaming loader: a loader thread appends the elements of a file in
+ * batches to the list and publishes the last loaded node, readers only
+ * follow the links up to it. The live readers are chained in readers,
+ * consumed is the lowest position they reported and the loader waits
+ * while it is window elements ahead of it. released counts the nodes
+ * freed from the head, positions count from the original head.
+ * The list itself is only changed with the lock held.
+ */
+typedef struct dll_stream
+{
+    dll_t *list;
+    FILE *fp;
+    uint64_t left;
+    void **items;
+    char *buffer;
+    unsigned long size;
+    unsigned long window;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t loaded;
+    pthread_cond_t space;
+    dll_node_t *last;
+    unsigned long count;
+    unsigned long consumed;
+    unsigned long released;
+    dll_streamIter_t *readers;
+    short int done;
+    short int ok;
+    short int finishing;
+} dll_stream_t;
+
+static pthread_mutex_t dll_reclaimLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dll_reclaimWork = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dll_reclaimDone = PTHREAD_COND_INITIALIZER;
+static dll_retired_t *dll_retiredHead = NULL;
+static dll_retired_t *dll_retiredTail = NULL;
+static unsigned long dll_reclaimPending = 0;
+static short int dll_reclaimRunning = 0;
+
+static pthread_mutex_t dll_parallelBusy = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t dll_parallelLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dll_parallelWork = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dll_parallelDone = PTHREAD_COND_INITIALIZER;
+static dll_segment_t *dll_parallelSegs = NULL;
+static unsigned int dll_parallelNext = 0;
+static unsigned int dll_parallelCount = 0;
+static unsigned int dll_parallelPending = 0;
+static unsigned int dll_parallelWorkers = 0;
+
 /**
  * static function definitions
  */
-static dll_node_t* dll_createNode(void *data);
-static dll_node_t* dll_addFirstNode(dll_t *list, void *data);
+static dll_node_t* dll_poolAlloc(dll_pool_t *pool);
+static short int dll_poolGrow(dll_pool_t *pool, unsigned long nodes);
+static void dll_poolRelease(dll_pool_t *pool);
+static short int dll_hashResize(dll_hash_t *hash, unsigned long capacity);
+static short int dll_hashInsert(dll_t *list, dll_node_t *node);
+static void dll_hashRemove(dll_t *list, dll_node_t *node);
+static short int dll_hashReserve(dll_hash_t *hash, unsigned long count);
+static unsigned int dll_skipHeight(dll_t *list);
+static void dll_skipLocate(dll_t *list, dll_node_t *x, dll_skip_t **pred, unsigned long *dist);
+static void dll_skipInsert(dll_t *list, dll_node_t *new);
+static void dll_skipRemove(dll_t *list, dll_node_t *del);
+static void dll_skipAppend(dll_t *list, dll_node_t *first);
+static void dll_skipBuild(dll_t *list);
+static void dll_skipRelease(dll_t *list);
+static dll_node_t* dll_createNode(dll_t *list, void *data);
+static void dll_releaseNode(dll_t *list, dll_node_t *del);
+static dll_node_t* dll_createChain(dll_t *list, void **items, unsigned long n, dll_node_t **last);
+static dll_node_t* dll_insert(dll_t *list, dll_node_t *prev, void *data);
+static dll_node_t* dll_locate(dll_t *list, unsigned long index);
+static dll_node_t* dll_sortedLocate(dll_t *list, void *data, short int after);
+static short int dll_inOrder(dll_t *list, dll_node_t *first, dll_node_t *last);
 static void dll_freeNode(dll_t *list, dll_node_t *del);
+static dll_node_t* dll_mergeSort(dll_t *list, dll_node_t *head, dll_node_t **tail);
+static void* dll_reclaimer(void *arg);
+static short int dll_compactBegin(dll_t *list);
+static unsigned long dll_compactMove(dll_t *list, unsigned long nodes);
+static void dll_hashReplace(dll_t *list, dll_node_t *old, dll_node_t *new);
+static FILE* dll_openFile(const char *path, uint64_t *count);
+static long dll_readBatch(dll_t *list, FILE *fp, uint64_t *left, void **items, char **buffer, unsigned long *size);
+static void dll_freeBatch(dll_t *list, void **items, long batch);
+static void* dll_streamLoader(void *arg);
+static void dll_streamConsumed(dll_stream_t *stream);
+static void dll_streamDetach(dll_streamIter_t *it);
+#ifdef DLL_STATS
+static void dll_statsRecord(unsigned long long *histogram, struct timespec *start);
+#endif
+static void* dll_sortWorker(void *arg);
+static void* dll_mergeWorker(void *arg);
+static void dll_sortRuns(dll_sortRun_t *runs, unsigned int threads, void* (*worker)(void*), unsigned int step);
+static dll_keyed_t* dll_radixSort(dll_keyed_t *keyed, dll_keyed_t *tmp, unsigned long n);
+static void dll_relink(dll_t *list, dll_keyed_t *keyed);
+static int dll_rankCompare(dll_t *list, dll_keyed_t *a, dll_keyed_t *b);
+static void dll_heapSift(dll_t *list, dll_keyed_t *heap, unsigned long n, unsigned long i);
+static unsigned int dll_segmentCount(dll_t *list, unsigned int threads);
+static void dll_segment(dll_t *list, dll_segment_t *segs, unsigned int threads);
+static void dll_runSegments(dll_segment_t *segs, unsigned int threads);
+static void* dll_segmentWorker(void *arg);
+static void* dll_parallelWorker(void *arg);
 
 /**
  * Creates a new doubly linked list.
@@ -53,6 +322,21 @@ dll_t* dll_create(void)
     {
         new->head = new->tail = new->curr = NULL;
         new->size = 0;
+        new->compareFn = NULL;
+        new->freeFn = NULL;
+        new->printFn = NULL;
+        new->hashFn = NULL;
+        new->serializeFn = NULL;
+        new->deserializeFn = NULL;
+        new->pool = NULL;
+        new->hash = NULL;
+        new->index = NULL;
+        new->compact = NULL;
+        new->seed = 88172645463325252ULL;
+        new->sorted = 0;
+#ifdef DLL_STATS
+        memset(&new->stats, 0, sizeof(dll_stats_t));
+#endif
     }
     else
     {
@@ -62,6 +346,124 @@ dll_t* dll_create(void)
     return new;
 }
 
+/**
+ * Sets consumed to the lowest position the live readers reported and
+ * wakes the loader if it moved on. Without readers it stays unchanged.
+ * Called with the lock of the stream held.
+ *
+ * @param dll_stream_t *stream: pointer to the stream
+ * @return void
+ */
+void dll_streamConsumed(dll_stream_t *stream)
+{
+    dll_streamIter_t *it;
+    unsigned long consumed;
+
+    if (!stream->readers)
+        return;
+
+    consumed = stream->readers->reported;
+
+    for (it = stream->readers->nextReader; it; it = it->nextReader)
+        if (it->reported < consumed)
+            consumed = it->reported;
+
+    if (consumed > stream->consumed)
+        pthread_cond_signal(&stream->space);
+
+    stream->consumed = consumed;
+}
+
+/**
+ * Removes an iterator from the readers of its stream, if it is one.
+ * Called with the lock of the stream held.
+ *
+ * @param dll_streamIter_t *it: pointer to the iterator
+ * @return void
+ */
+void dll_streamDetach(dll_streamIter_t *it)
+{
+    dll_streamIter_t **link;
+
+    for (link = &it->stream->readers; *link; link = &(*link)->nextReader)
+    {
+        if (*link == it)
+        {
+            *link = it->nextReader;
+            dll_streamConsumed(it->stream);
+            break;
+        }
+    }
+}
+
+/**
+ * Creates a new doubly linked list which allocates its nodes from a pool.
+ * The pool carves the nodes from chunks of chunkNodes nodes and recycles
+ * freed nodes, instead of calling malloc and free for every node.
+ *
+ * @param unsigned long chunkNodes: number of nodes per chunk
+ * @return dll_t*: pointer of new doubly linked list
+ */
+dll_t* dll_createWithPool(unsigned long chunkNodes)
+{
+    assert(chunkNodes);
+
+    dll_t *new = dll_create();
+
+    if (new)
+    {
+        new->pool = malloc(sizeof(dll_pool_t));
+
+        if (new->pool)
+        {
+            new->pool->free = NULL;
+            new->pool->chunks = NULL;
+            new->pool->unused = NULL;
+            new->pool->left = 0;
+            new->pool->chunkNodes = chunkNodes;
+            new->pool->refs = 1;
+        }
+        else
+        {
+            puts("ERROR: Out of memory");
+            free(new);
+            new = NULL;
+        }
+    }
+
+    return new;
+}
+
+/**
+ * Creates a new doubly linked list which allocates its nodes from the
+ * same pool as another list, so nodes can be spliced between them.
+ * The callbacks of the other list are registered on the new list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list to share with
+ * @return dll_t*: pointer of new doubly linked list
+ */
+dll_t* dll_createSharingPool(dll_t *list)
+{
+    assert(list);
+
+    dll_t *new = dll_create();
+
+    if (new)
+    {
+        new->compareFn = list->compareFn;
+        new->freeFn = list->freeFn;
+        new->printFn = list->printFn;
+        new->serializeFn = list->serializeFn;
+        new->deserializeFn = list->deserializeFn;
+        new->pool = list->pool;
+
+        if (new->pool)
+            new->pool->refs++;
+    }
+
+    return new;
+}
+
 /**
  * Registers compareFn callback function on the list.
  *
@@ -107,6 +509,185 @@ void dll_registerPrintFn(dll_t *list, void (*printFn)(void*) )
     list->printFn = printFn;
 }
 
+/**
+ * Registers serializeFn callback function on the list.
+ * serializeFn(data, buffer, size) writes the data into the buffer of
+ * size bytes and returns the number of bytes needed. If they do not fit,
+ * it is called again with a buffer of the needed size.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long (*serializeFn)(void*, void*, unsigned long): callback function serializeFn
+ * @return void
+ */
+void dll_registerSerializeFn(dll_t *list, unsigned long (*serializeFn)(void*, void*, unsigned long) )
+{
+    assert(list);
+    assert(serializeFn);
+
+    list->serializeFn = serializeFn;
+}
+
+/**
+ * Registers deserializeFn callback function on the list.
+ * deserializeFn(buffer, size) creates the data from the size bytes
+ * written by serializeFn, or returns NULL on failure.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void* (*deserializeFn)(void*, unsigned long): callback function deserializeFn
+ * @return void
+ */
+void dll_registerDeserializeFn(dll_t *list, void* (*deserializeFn)(void*, unsigned long) )
+{
+    assert(list);
+    assert(deserializeFn);
+
+    list->deserializeFn = deserializeFn;
+}
+
+/**
+ * Registers hashFn callback function on the list and builds a hash index
+ * over all nodes. The index is maintained by every operation, thus
+ * dll_searchHash finds data in expected constant time.
+ * Data which is equal by compareFn must have the same hash.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long (*hashFn)(void*): callback function hashFn
+ * @return int: success
+ */
+short int dll_registerHashFn(dll_t *list, unsigned long (*hashFn)(void*) )
+{
+    assert(list);
+    assert(hashFn);
+
+    dll_node_t *n;
+
+    if (list->hash)
+    {
+        free(list->hash->slots);
+        free(list->hash);
+    }
+
+    list->hashFn = hashFn;
+    list->hash = malloc(sizeof(dll_hash_t));
+
+    if (list->hash)
+    {
+        list->hash->slots = NULL;
+        list->hash->capacity = list->hash->used = 0;
+
+        if (dll_hashResize(list->hash, 16))
+        {
+            for (n = list->head; n; n = n->next)
+            {
+                if (!dll_hashInsert(list, n))
+                    break;
+            }
+
+            if (!n)
+                return 1;
+
+            free(list->hash->slots);
+        }
+        free(list->hash);
+        list->hash = NULL;
+    }
+
+    puts("ERROR: Out of memory");
+
+    return 0;
+}
+
+/**
+ * Enables the skip index, which makes dll_get, dll_set, dll_delete
+ * and dll_indexOf run in expected O(log n). Pushing to the head or
+ * the tail stays O(1), adding at a node costs expected O(log n).
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return int: success
+ */
+short int dll_enableIndex(dll_t *list)
+{
+    assert(list);
+
+    if (!list->index)
+    {
+        list->index = malloc(sizeof(dll_skip_t) + DLL_SKIP_LEVELS * sizeof(dll_skipLink_t));
+
+        if (!list->index)
+        {
+            puts("ERROR: Out of memory");
+            return 0;
+        }
+
+        list->index->node = NULL;
+        list->index->height = DLL_SKIP_LEVELS;
+        dll_skipBuild(list);
+    }
+
+    return 1;
+}
+
+/**
+ * Disables the skip index and frees it from memory. The sorted mode
+ * relies on the index and is disabled as well.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_disableIndex(dll_t *list)
+{
+    assert(list);
+
+    if (list->index)
+    {
+        dll_skipRelease(list);
+        free(list->index);
+        list->index = NULL;
+        list->sorted = 0;
+    }
+}
+
+/**
+ * Enables the sorted mode: the list is sorted through the compareFn
+ * function, the skip index is enabled and the list is flagged as
+ * ordered. dll_insertSorted keeps it ordered, inserts and searches go
+ * down the index in O(log n). Operations which put a node out of order
+ * disable the sorted mode, the index stays enabled.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return int: success
+ */
+short int dll_enableSorted(dll_t *list)
+{
+    assert(list);
+    assert(list->compareFn);
+
+    if (!list->sorted)
+    {
+        dll_sort(list);
+
+        if (!dll_enableIndex(list))
+            return 0;
+
+        list->sorted = 1;
+    }
+
+    return 1;
+}
+
+/**
+ * Disables the sorted mode, the order of the nodes is kept.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_disableSorted(dll_t *list)
+{
+    assert(list);
+
+    list->sorted = 0;
+}
+
 /**
  * Returns the head and sets the current to the head.
  *
@@ -242,6 +823,8 @@ void dll_traverse(dll_t *list, void (*callback)(void*) )
 
     dll_node_t *n = list->head;
 
+    DLL_STAT(list, ops[DLL_OP_TRAVERSE], 1);
+
     while (n)
     {
         callback(n->data); // or (*callback)(i);
@@ -250,68 +833,564 @@ void dll_traverse(dll_t *list, void (*callback)(void*) )
 }
 
 /**
- * Checks if a node exists in the doubly linked list.
+ * Traverses the list with several threads, each one walks a segment of
+ * about the same length. The callback is called concurrently and in no
+ * particular order, so it must not modify shared state. The list must
+ * not be modified meanwhile.
  *
  * @param dll_t *list: pointer to the doubly linked list
- * @param dll_node_t *node: node to test against
- * @return int: success
+ * @param void (*callback)(void*): callback function
+ * @param unsigned int threads: maximum number of threads
+ * @return void
  */
-short int dll_contains(dll_t *list, dll_node_t *node)
+void dll_parallelTraverse(dll_t *list, void (*callback)(void*), unsigned int threads)
 {
     assert(list);
+    assert(callback);
 
-    if (node && list->size)
-    {
-        dll_node_t *n = list->head;
+    unsigned int t;
 
-        while (n)
-        {
-            if (n == node)
-                return 1;
-            n = n->next;
-        }
-    }
+    threads = dll_segmentCount(list, threads);
 
-    return 0;
+    dll_segment_t segs[DLL_PARALLEL_THREADS];
+
+    DLL_STAT(list, ops[DLL_OP_TRAVERSE], 1);
+    dll_segment(list, segs, threads);
+
+    for (t = 0; t < threads; t++)
+        segs[t].callback = callback;
+
+    dll_runSegments(segs, threads);
 }
 
 /**
- * Gets the node at the index.
+ * Creates a new list with the result of mapFn for the data of every
+ * node, in the same order. mapFn is called concurrently by several
+ * threads. The new list shares the pool and the callbacks with the list,
+ * so mapFn returns data of the same kind or the callbacks are registered
+ * again afterwards.
  *
  * @param dll_t *list: pointer to the doubly linked list
- * @param unsigned long index: index
- * @return dll_node_t*: pointer to the pushed node
+ * @param void* (*mapFn)(void*): returns the new data of the data
+ * @param unsigned int threads: maximum number of threads
+ * @return dll_t*: pointer of the new list, NULL if out of memory
  */
-dll_node_t* dll_get(dll_t *list, unsigned long index)
+dll_t* dll_map(dll_t *list, void* (*mapFn)(void*), unsigned int threads)
 {
     assert(list);
-    assert(index < list->size);
+    assert(mapFn);
 
-    if (index < list->size / 2)
-    {
-        list->curr = list->head;
+    dll_t *new = dll_createSharingPool(list);
+    void **items = NULL;
+    unsigned long i;
+    unsigned int t;
 
-        while (index--)
-        {
-            list->curr = list->curr->next;
-        }
-    }
-    else
-    {
-        index = list->size - index - 1;
-        list->curr = list->tail;
+    if (!new)
+        return NULL;
 
-        while (index--)
-        {
-            list->curr = list->curr->prev;
-        }
+    if (!list->size)
+        return new;
+
+    items = malloc(list->size * sizeof(void*));
+
+    if (!items)
+    {
+        puts("ERROR: Out of memory");
+        dll_clear(new);
+        return NULL;
     }
 
-    return list->curr;
-}
+    threads = dll_segmentCount(list, threads);
+
+    dll_segment_t segs[DLL_PARALLEL_THREADS];
+
+    dll_segment(list, segs, threads);
+
+    for (t = 0, i = 0; t < threads; i += segs[t].count, t++)
+    {
+        segs[t].mapFn = mapFn;
+        segs[t].items = items + i;
+    }
+
+    dll_runSegments(segs, threads);
+
+    if (!dll_pushTailBulk(new, items, list->size))
+    {
+        if (new->freeFn)
+            for (i = 0; i < list->size; i++)
+                new->freeFn(items[i]);
+
+        dll_clear(new);
+        new = NULL;
+    }
+
+    free(items);
+
+    return new;
+}
+
+/**
+ * Reduces the data of the list to a single value with several threads.
+ *
+ * Every thread folds the data of its segment from head to tail with
+ * reduceFn(acc, data), starting with acc NULL at the first data of the
+ * segment. The results of neighbouring segments are then combined in
+ * list order with combineFn(left, right) by the calling thread. Both
+ * return the new accumulator, reduceFn is called concurrently.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void* (*reduceFn)(void*, void*): folds data into an accumulator
+ * @param void* (*combineFn)(void*, void*): combines two accumulators
+ * @param unsigned int threads: maximum number of threads
+ * @return void*: the accumulator, NULL if the list is empty
+ */
+void* dll_reduce(dll_t *list, void* (*reduceFn)(void*, void*), void* (*combineFn)(void*, void*), unsigned int threads)
+{
+    assert(list);
+    assert(reduceFn);
+    assert(combineFn);
+
+    void *acc;
+    unsigned int t;
+
+    if (!list->size)
+        return NULL;
+
+    threads = dll_segmentCount(list, threads);
+
+    dll_segment_t segs[DLL_PARALLEL_THREADS];
+
+    dll_segment(list, segs, threads);
+
+    for (t = 0; t < threads; t++)
+        segs[t].reduceFn = reduceFn;
+
+    dll_runSegments(segs, threads);
+
+    acc = segs[0].acc;
+    for (t = 1; t < threads; t++)
+        acc = combineFn(acc, segs[t].acc);
+
+    return acc;
+}
+
+/**
+ * Returns the number of segments the list is cut into, at most threads
+ * and DLL_PARALLEL_THREADS and at least one, with at least
+ * DLL_PARALLEL_GRAIN nodes per segment.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned int threads: maximum number of threads
+ * @return unsigned int: number of segments
+ */
+unsigned int dll_segmentCount(dll_t *list, unsigned int threads)
+{
+    if (threads > DLL_PARALLEL_THREADS)
+        threads = DLL_PARALLEL_THREADS;
+    if (threads > list->size / DLL_PARALLEL_GRAIN)
+        threads = list->size / DLL_PARALLEL_GRAIN;
+
+    return threads ? threads : 1;
+}
+
+/**
+ * Cuts the list into segments of the same length, the last one takes
+ * the rest. The first nodes are found with the skip index if enabled,
+ * otherwise the first half of them by a walk from the head and the
+ * second half by a walk from the tail.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_segment_t *segs: array of segments
+ * @param unsigned int threads: number of segments
+ * @return void
+ */
+void dll_segment(dll_t *list, dll_segment_t *segs, unsigned int threads)
+{
+    unsigned long per = list->size / threads, i;
+    unsigned int t, half = (threads + 1) / 2;
+    dll_node_t *n;
+
+    memset(segs, 0, threads * sizeof(dll_segment_t));
+
+    for (t = 0; t < threads; t++)
+        segs[t].count = t == threads - 1 ? list->size - t * per : per;
+
+    if (!list->size)
+        return;
+
+    if (list->index)
+    {
+        for (t = 0; t < threads; t++)
+            segs[t].first = dll_locate(list, t * per);
+        return;
+    }
+
+    for (t = 0, i = 0, n = list->head; t < half; t++)
+    {
+        for (; i < t * per; i++)
+            n = n->next;
+        segs[t].first = n;
+    }
+
+    for (t = threads, i = list->size - 1, n = list->tail; t-- > half; )
+    {
+        for (; i > t * per; i--)
+            n = n->prev;
+        segs[t].first = n;
+    }
+}
+
+/**
+ * Runs dll_segmentWorker for every segment on the worker pool, starting
+ * the missing workers. The calling thread walks the first segment and
+ * then takes the segments no worker took yet, so all segments are done
+ * even if no worker could be started. While the pool is busy with
+ * another call, e.g. from a callback, the calling thread walks all
+ * segments itself.
+ *
+ * @param dll_segment_t *segs: array of segments
+ * @param unsigned int threads: number of segments
+ * @return void
+ */
+void dll_runSegments(dll_segment_t *segs, unsigned int threads)
+{
+    dll_segment_t *seg;
+    pthread_t thread;
+    unsigned int t;
+
+    if (threads == 1 || pthread_mutex_trylock(&dll_parallelBusy))
+    {
+        for (t = 0; t < threads; t++)
+            dll_segmentWorker(&segs[t]);
+        return;
+    }
+
+    pthread_mutex_lock(&dll_parallelLock);
+
+    while (dll_parallelWorkers < threads - 1
+           && pthread_create(&thread, NULL, dll_parallelWorker, NULL) == 0)
+    {
+        pthread_detach(thread);
+        dll_parallelWorkers++;
+    }
+
+    dll_parallelSegs = segs;
+    dll_parallelNext = 1;
+    dll_parallelCount = threads;
+    dll_parallelPending = threads - 1;
+    pthread_cond_broadcast(&dll_parallelWork);
+
+    pthread_mutex_unlock(&dll_parallelLock);
+
+    dll_segmentWorker(&segs[0]);
+
+    pthread_mutex_lock(&dll_parallelLock);
+
+    while (dll_parallelNext < dll_parallelCount)
+    {
+        seg = &dll_parallelSegs[dll_parallelNext++];
+        pthread_mutex_unlock(&dll_parallelLock);
+        dll_segmentWorker(seg);
+        pthread_mutex_lock(&dll_parallelLock);
+        dll_parallelPending--;
+    }
+
+    while (dll_parallelPending)
+        pthread_cond_wait(&dll_parallelDone, &dll_parallelLock);
+
+    dll_parallelSegs = NULL;
+    dll_parallelNext = dll_parallelCount = 0;
+
+    pthread_mutex_unlock(&dll_parallelLock);
+    pthread_mutex_unlock(&dll_parallelBusy);
+}
+
+/**
+ * Worker thread of the pool: waits for segments and walks them, the
+ * last one to finish wakes the calling thread.
+ *
+ * @param void *arg: unused
+ * @return void*: never returns
+ */
+void* dll_parallelWorker(void *arg)
+{
+    dll_segment_t *seg;
+
+    pthread_mutex_lock(&dll_parallelLock);
+
+    for (;;)
+    {
+        while (dll_parallelNext >= dll_parallelCount)
+            pthread_cond_wait(&dll_parallelWork, &dll_parallelLock);
+
+        seg = &dll_parallelSegs[dll_parallelNext++];
+
+        pthread_mutex_unlock(&dll_parallelLock);
+        dll_segmentWorker(seg);
+        pthread_mutex_lock(&dll_parallelLock);
+
+        if (--dll_parallelPending == 0)
+            pthread_cond_broadcast(&dll_parallelDone);
+    }
+
+    return NULL;
+}
+
+/**
+ * Walks one segment.
+ *
+ * @param void *arg: the segment
+ * @return void*: NULL
+ */
+void* dll_segmentWorker(void *arg)
+{
+    dll_segment_t *seg = arg;
+    dll_node_t *n = seg->first;
+    unsigned long i;
+
+    for (i = 0; i < seg->count; i++, n = n->next)
+    {
+        if (seg->callback)
+            seg->callback(n->data);
+        else if (seg->mapFn)
+            seg->items[i] = seg->mapFn(n->data);
+        else
+            seg->acc = seg->reduceFn(seg->acc, n->data);
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks if a node exists in the doubly linked list.
+ * Every node is tagged with the list owning it, so this takes constant time.
+ * With DLL_VALIDATE defined, the tag is validated by walking the list.
+ * The tag is read through the node, so the node must not have been freed:
+ * pass NULL or a node that is still in this or another list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *node: live node to test against, or NULL
+ * @return int: success
+ */
+short int dll_contains(dll_t *list, dll_node_t *node)
+{
+    assert(list);
+
+#ifdef DLL_VALIDATE
+    dll_node_t *n = list->head;
+
+    while (n && n != node)
+        n = n->next;
+
+    assert(!node || (n == node) == (node->owner == list));
+#endif
+
+    return node && node->owner == list;
+}
+
+/**
+ * Finds the node at the index, without changing the current node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long index: index
+ * @return dll_node_t*: pointer to the node
+ */
+dll_node_t* dll_locate(dll_t *list, unsigned long index)
+{
+    assert(list);
+    assert(index < list->size);
+
+    dll_node_t *n;
+
+    if (list->index)
+    {
+        dll_skip_t *t = list->index;
+        unsigned long pos = 0; /* position + 1, the head tower is at -1 */
+        int l;
+
+        for (l = DLL_SKIP_LEVELS - 1; l >= 0; l--)
+        {
+            while (t->link[l].next && pos + t->link[l].width <= index + 1)
+            {
+                DLL_STAT(list, getVisits, 1);
+                pos += t->link[l].width;
+                t = t->link[l].next;
+            }
+        }
+
+        if (t->node)
+        {
+            n = t->node;
+            index -= pos - 1;
+        }
+        else
+        {
+            n = list->head;
+        }
+
+        while (index--)
+        {
+            DLL_STAT(list, getVisits, 1);
+            n = n->next;
+        }
+    }
+    else if (index < list->size / 2)
+    {
+        n = list->head;
+
+        while (index--)
+        {
+            DLL_STAT(list, getVisits, 1);
+            n = n->next;
+        }
+    }
+    else
+    {
+        index = list->size - index - 1;
+        n = list->tail;
+
+        while (index--)
+        {
+            DLL_STAT(list, getVisits, 1);
+            n = n->prev;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * Finds the last node before the position of the data in a list in
+ * sorted mode, down the skip index in O(log n). The node is the last
+ * one with smaller data or, with after, with smaller or equal data,
+ * i.e. the one whose compareFn result is below after.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void *data: data pointer
+ * @param short int after: include the nodes with equal data
+ * @return dll_node_t*: the node, NULL if the data belongs to the head
+ */
+dll_node_t* dll_sortedLocate(dll_t *list, void *data, short int after)
+{
+    dll_node_t *n = NULL, *next;
+
+    /* ordered pushes to the tail are common */
+    if (list->tail && DLL_COMPARE(list, list->tail->data, data) < after)
+        return list->tail;
+
+    if (list->index)
+    {
+        dll_skip_t *t = list->index;
+        int l;
+
+        for (l = DLL_SKIP_LEVELS - 1; l >= 0; l--)
+        {
+            while (t->link[l].next && DLL_COMPARE(list, t->link[l].next->node->data, data) < after)
+            {
+                DLL_STAT(list, searchVisits, 1);
+                t = t->link[l].next;
+            }
+        }
+
+        n = t->node;
+    }
+
+    next = n ? n->next : list->head;
+
+    while (next && DLL_COMPARE(list, next->data, data) < after)
+    {
+        DLL_STAT(list, searchVisits, 1);
+        n = next;
+        next = next->next;
+    }
+
+    return n;
+}
+
+/**
+ * Checks that the nodes from first to last are in order through the
+ * compareFn function, together with their neighbours.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *first: first node of the range
+ * @param dll_node_t *last: last node of the range
+ * @return int: in order
+ */
+short int dll_inOrder(dll_t *list, dll_node_t *first, dll_node_t *last)
+{
+    dll_node_t *n = first->prev ? first->prev : first;
+    dll_node_t *end = last->next ? last->next : last;
+
+    for (; n != end; n = n->next)
+    {
+        if (DLL_COMPARE(list, n->data, n->next->data) > 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Gets the node at the index. Sets the current node to the node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long index: index
+ * @return dll_node_t*: pointer to the node
+ */
+dll_node_t* dll_get(dll_t *list, unsigned long index)
+{
+#ifdef DLL_STATS
+    struct timespec start;
+#endif
+
+    DLL_TIMER(start);
+    DLL_STAT(list, ops[DLL_OP_GET], 1);
+
+    list->curr = dll_locate(list, index);
+
+    DLL_LATENCY(list, getLatency, start);
+
+    return list->curr;
+}
+
+
+/**
+ * Returns the index of a node of the list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *node: node of the list
+ * @return unsigned long: index
+ */
+unsigned long dll_indexOf(dll_t *list, dll_node_t *node)
+{
+    assert(list);
+    assert(dll_contains(list, node));
+
+    unsigned long index = 0;
+
+    if (list->index)
+    {
+        dll_skip_t *pred[DLL_SKIP_LEVELS];
+        unsigned long dist[DLL_SKIP_LEVELS];
+
+        dll_skipLocate(list, node, pred, dist);
+        index = dist[DLL_SKIP_LEVELS - 1] - 1;
+    }
+    else
+    {
+        while (node->prev)
+        {
+            node = node->prev;
+            index++;
+        }
+    }
+
+    return index;
+}
 
 /**
  * Searches for data from head to tail.
+ * In sorted mode the search stops at the position of the data.
  *
  * @param dll_t *list: pointer to the doubly linked list
  * @param void *data: data pointer
@@ -325,11 +1404,20 @@ dll_node_t* dll_searchHeadToTail(dll_t *list, void *data)
 
     dll_node_t *n = list->head;
 
+    if (list->sorted)
+    {
+        n = dll_sortedLocate(list, data, 0);
+        n = n ? n->next : list->head;
+
+        return n && !DLL_COMPARE(list, n->data, data) ? n : NULL;
+    }
+
     if (list->size)
     {
         while (n)
         {
-            if (!list->compareFn(n->data, data))
+            DLL_STAT(list, searchVisits, 1);
+            if (!DLL_COMPARE(list, n->data, data))
                 return n;
             n = n->next;
         }
@@ -340,6 +1428,7 @@ dll_node_t* dll_searchHeadToTail(dll_t *list, void *data)
 
 /**
  * Searches for data from tail to head.
+ * In sorted mode the search stops at the position of the data.
  *
  * @param dll_t *list: pointer to the doubly linked list
  * @param void *data: data pointer
@@ -353,11 +1442,19 @@ dll_node_t* dll_searchTailToHead(dll_t *list, void *data)
 
     dll_node_t *n = list->tail;
 
+    if (list->sorted)
+    {
+        n = dll_sortedLocate(list, data, 1);
+
+        return n && !DLL_COMPARE(list, n->data, data) ? n : NULL;
+    }
+
     if (list->size)
     {
         while (n)
         {
-            if (!list->compareFn(n->data, data))
+            DLL_STAT(list, searchVisits, 1);
+            if (!DLL_COMPARE(list, n->data, data))
                 return n;
             n = n->prev;
         }
@@ -368,6 +1465,7 @@ dll_node_t* dll_searchTailToHead(dll_t *list, void *data)
 
 /**
  * Searches for data from both, head and tail alternating.
+ * In sorted mode the search is done like dll_searchHeadToTail.
  *
  * @param dll_t *list: pointer to the doubly linked list
  * @param void *data: data pointer
@@ -381,29 +1479,34 @@ dll_node_t* dll_searchHeadAndTail(dll_t *list, void *data)
 
     dll_node_t *i = list->head, *j = list->tail;
 
+    if (list->sorted)
+        return dll_searchHeadToTail(list, data);
+
     if (list->size)
     {
         if (list->size % 2)
         {
             do
             {
-                if (!list->compareFn(i->data, data))
+                DLL_STAT(list, searchVisits, 2);
+                if (!DLL_COMPARE(list, i->data, data))
                     return i;
-                if (!list->compareFn(j->data, data))
+                if (!DLL_COMPARE(list, j->data, data))
                     return j;
 
                 i = i->next;
                 j = j->prev;
             }
-            while (i->prev != j->next);
+            while (i && i->prev != j->next);
         }
         else
         {
             while (i != j->next)
             {
-                if (!list->compareFn(i->data, data))
+                DLL_STAT(list, searchVisits, 2);
+                if (!DLL_COMPARE(list, i->data, data))
                     return i;
-                if (!list->compareFn(j->data, data))
+                if (!DLL_COMPARE(list, j->data, data))
                     return j;
 
                 i = i->next;
@@ -416,11 +1519,41 @@ dll_node_t* dll_searchHeadAndTail(dll_t *list, void *data)
 }
 
 /**
- * Searches for a node with the specific data. Sets the current node to the found node.
+ * Searches for data in the hash index registered with dll_registerHashFn.
+ * If several nodes hold equal data, any of them may be returned.
  *
  * @param dll_t *list: pointer to the doubly linked list
  * @param void *data: data pointer
- * @param int mode: search mode
+ * @return dll_node_t*: pointer to the found node
+ */
+dll_node_t* dll_searchHash(dll_t *list, void *data)
+{
+    assert(list);
+    assert(list->compareFn);
+    assert(list->hash);
+    assert(data);
+
+    dll_hash_t *hash = list->hash;
+    unsigned long h = list->hashFn(data), i = h & (hash->capacity - 1);
+
+    while (hash->slots[i].node)
+    {
+        DLL_STAT(list, searchVisits, 1);
+        if (hash->slots[i].hash == h && !DLL_COMPARE(list, hash->slots[i].node->data, data))
+            return hash->slots[i].node;
+        i = (i + 1) & (hash->capacity - 1);
+    }
+
+    return NULL;
+}
+
+/**
+ * Searches for a node with the specific data. Sets the current node to the found node.
+ * Mode 4 uses the hash index, if no hash index is registered it falls back to mode 1.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void *data: data pointer
+ * @param int mode: search mode
  * @return dll_node_t*: pointer to the found node
  */
 dll_node_t* dll_search(dll_t *list, void *data, short int mode)
@@ -429,9 +1562,23 @@ dll_node_t* dll_search(dll_t *list, void *data, short int mode)
     assert(data);
 
     dll_node_t *search = NULL;
+#ifdef DLL_STATS
+    struct timespec start;
+#endif
+
+    DLL_TIMER(start);
+    DLL_STAT(list, ops[DLL_OP_SEARCH], 1);
 
     switch (mode)
     {
+    case 4:
+        if (list->hash)
+        {
+            search = dll_searchHash(list, data);
+            break;
+        }
+        search = dll_searchHeadToTail(list, data);
+        break;
     case 3:
         search = dll_searchHeadAndTail(list, data);
         break;
@@ -443,399 +1590,2965 @@ dll_node_t* dll_search(dll_t *list, void *data, short int mode)
         search = dll_searchHeadToTail(list, data);
     }
 
-    return list->curr = search;
+    DLL_LATENCY(list, searchLatency, start);
+
+    return list->curr = search;
+}
+
+/**
+ * Rehashes the hash index into a table with a new capacity.
+ *
+ * @param dll_hash_t *hash: pointer to the hash index
+ * @param unsigned long capacity: new capacity, a power of two
+ * @return int: success
+ */
+short int dll_hashResize(dll_hash_t *hash, unsigned long capacity)
+{
+    dll_hashEntry_t *slots = calloc(capacity, sizeof(dll_hashEntry_t));
+    unsigned long i, j;
+
+    if (!slots)
+        return 0;
+
+    for (i = 0; i < hash->capacity; i++)
+    {
+        if (hash->slots[i].node)
+        {
+            j = hash->slots[i].hash & (capacity - 1);
+
+            while (slots[j].node)
+                j = (j + 1) & (capacity - 1);
+
+            slots[j] = hash->slots[i];
+        }
+    }
+
+    free(hash->slots);
+    hash->slots = slots;
+    hash->capacity = capacity;
+
+    return 1;
+}
+
+/**
+ * Grows the hash index in advance, so count more nodes can be added
+ * without a failing resize.
+ *
+ * @param dll_hash_t *hash: pointer to the hash index
+ * @param unsigned long count: number of nodes to add
+ * @return int: success
+ */
+short int dll_hashReserve(dll_hash_t *hash, unsigned long count)
+{
+    unsigned long capacity = hash->capacity;
+
+    while ((hash->used + count) * 2 > capacity)
+        capacity *= 2;
+
+    return capacity == hash->capacity || dll_hashResize(hash, capacity);
+}
+
+/**
+ * Adds a node to the hash index, the table grows if it gets half full.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *node: node to add
+ * @return int: success
+ */
+short int dll_hashInsert(dll_t *list, dll_node_t *node)
+{
+    dll_hash_t *hash = list->hash;
+    unsigned long h = list->hashFn(node->data), i;
+
+    if ((hash->used + 1) * 2 > hash->capacity
+        && !dll_hashResize(hash, hash->capacity * 2)
+        && hash->used + 1 >= hash->capacity)
+        return 0;
+
+    i = h & (hash->capacity - 1);
+
+    while (hash->slots[i].node)
+        i = (i + 1) & (hash->capacity - 1);
+
+    hash->slots[i].hash = h;
+    hash->slots[i].node = node;
+    hash->used++;
+
+    return 1;
+}
+
+/**
+ * Removes a node from the hash index. The following entries of the
+ * probe sequence are shifted back, so no tombstones are needed.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *node: node to remove
+ * @return void
+ */
+void dll_hashRemove(dll_t *list, dll_node_t *node)
+{
+    dll_hash_t *hash = list->hash;
+    unsigned long mask = hash->capacity - 1;
+    unsigned long i = list->hashFn(node->data) & mask, j, k;
+
+    while (hash->slots[i].node != node)
+    {
+        assert(hash->slots[i].node);
+        i = (i + 1) & mask;
+    }
+
+    for (j = (i + 1) & mask; hash->slots[j].node; j = (j + 1) & mask)
+    {
+        k = hash->slots[j].hash & mask;
+
+        /* the entry at j may only move back if its home k is not in (i, j] */
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+
+        hash->slots[i] = hash->slots[j];
+        i = j;
+    }
+
+    hash->slots[i].node = NULL;
+    hash->used--;
+}
+
+/**
+ * Replaces a node by its moved copy in the hash index.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *old: node in the hash index
+ * @param dll_node_t *new: node replacing it
+ * @return void
+ */
+void dll_hashReplace(dll_t *list, dll_node_t *old, dll_node_t *new)
+{
+    dll_hash_t *hash = list->hash;
+    unsigned long mask = hash->capacity - 1;
+    unsigned long i = list->hashFn(new->data) & mask;
+
+    while (hash->slots[i].node != old)
+    {
+        assert(hash->slots[i].node);
+        i = (i + 1) & mask;
+    }
+
+    hash->slots[i].node = new;
+}
+
+/**
+ * Draws a random tower height, each level with probability 1/4.
+ * Only the head tower reaches the top level, so the climb of
+ * dll_skipLocate always ends there.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return unsigned int: height
+ */
+unsigned int dll_skipHeight(dll_t *list)
+{
+    unsigned long long r;
+    unsigned int height = 0;
+
+    /* xorshift64 */
+    list->seed ^= list->seed << 13;
+    list->seed ^= list->seed >> 7;
+    list->seed ^= list->seed << 17;
+
+    for (r = list->seed; !(r & 3) && height < DLL_SKIP_LEVELS - 1; r >>= 2)
+        height++;
+
+    return height;
+}
+
+/**
+ * Finds on every level the last tower at or before the node x and
+ * its distance to x, by climbing back from x to the head tower.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *x: node, NULL for the position before the head
+ * @param dll_skip_t **pred: returns the tower of each level
+ * @param unsigned long *dist: returns the distance of each tower to x
+ * @return void
+ */
+void dll_skipLocate(dll_t *list, dll_node_t *x, dll_skip_t **pred, unsigned long *dist)
+{
+    dll_skip_t *t = list->index;
+    unsigned long d = 0;
+    unsigned int l;
+
+    while (x && !x->skip)
+    {
+        x = x->prev;
+        d++;
+    }
+
+    if (x)
+        t = x->skip;
+
+    for (l = 0; l < DLL_SKIP_LEVELS; l++)
+    {
+        while (t->height <= l)
+        {
+            t = t->link[l - 1].prev;
+            d += t->link[l - 1].width;
+        }
+        pred[l] = t;
+        dist[l] = d;
+    }
+}
+
+/**
+ * Adds a node, which was just linked into the list, to the skip index.
+ * For a new tail the last towers are taken without climbing.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *new: new node
+ * @return void
+ */
+void dll_skipInsert(dll_t *list, dll_node_t *new)
+{
+    dll_skip_t *pred[DLL_SKIP_LEVELS], *t = NULL;
+    unsigned long dist[DLL_SKIP_LEVELS];
+    unsigned int l, height = dll_skipHeight(list);
+
+    if (new == list->tail)
+    {
+        for (l = 0; l < DLL_SKIP_LEVELS; l++)
+        {
+            pred[l] = list->index->link[l].prev;
+            dist[l] = pred[l]->link[l].width - 1;
+        }
+    }
+    else
+    {
+        dll_skipLocate(list, new->prev, pred, dist);
+    }
+
+    if (height)
+    {
+        t = malloc(sizeof(dll_skip_t) + height * sizeof(dll_skipLink_t));
+
+        if (t)
+        {
+            t->node = new;
+            t->height = height;
+        }
+        else
+        {
+            height = 0;
+        }
+    }
+    new->skip = t;
+
+    for (l = 0; l < DLL_SKIP_LEVELS; l++)
+    {
+        dll_skipLink_t *u = &pred[l]->link[l];
+
+        if (l < height)
+        {
+            t->link[l].prev = pred[l];
+            t->link[l].next = u->next;
+            t->link[l].width = u->width - dist[l];
+            if (u->next)
+                u->next->link[l].prev = t;
+            else
+                list->index->link[l].prev = t;
+            u->next = t;
+            u->width = dist[l] + 1;
+        }
+        else
+        {
+            u->width++;
+        }
+    }
+}
+
+/**
+ * Removes a node, which is still linked into the list, from the skip index.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *del: node to remove
+ * @return void
+ */
+void dll_skipRemove(dll_t *list, dll_node_t *del)
+{
+    dll_skip_t *pred[DLL_SKIP_LEVELS], *t = del->skip;
+    unsigned long dist[DLL_SKIP_LEVELS];
+    unsigned int l, height = t ? t->height : 0;
+
+    dll_skipLocate(list, del->prev, pred, dist);
+
+    for (l = 0; l < DLL_SKIP_LEVELS; l++)
+    {
+        dll_skipLink_t *u = &pred[l]->link[l];
+
+        if (l < height)
+        {
+            u->next = t->link[l].next;
+            u->width += t->link[l].width - 1;
+            if (u->next)
+                u->next->link[l].prev = pred[l];
+            else
+                list->index->link[l].prev = pred[l];
+        }
+        else
+        {
+            u->width--;
+        }
+    }
+
+    free(t);
+    del->skip = NULL;
+}
+
+/**
+ * Adds the nodes from first to the tail to the skip index, after they
+ * were linked to the end of the list at once.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *first: first node, which is not in the index yet
+ * @return void
+ */
+void dll_skipAppend(dll_t *list, dll_node_t *first)
+{
+    dll_node_t *n, *tail = list->tail;
+
+    /* every node is added as the tail of the nodes before */
+    for (n = first; n; n = n->next)
+    {
+        list->tail = n;
+        dll_skipInsert(list, n);
+    }
+
+    list->tail = tail;
+}
+
+/**
+ * Builds the skip index from scratch, after the nodes were relinked.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_skipBuild(dll_t *list)
+{
+    dll_skip_t *index = list->index;
+    unsigned int l;
+
+    dll_skipRelease(list);
+
+    for (l = 0; l < DLL_SKIP_LEVELS; l++)
+    {
+        index->link[l].prev = index;
+        index->link[l].next = NULL;
+        index->link[l].width = 1;
+    }
+
+    dll_skipAppend(list, list->head);
+}
+
+/**
+ * Frees all towers of the skip index, the head tower is kept.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_skipRelease(dll_t *list)
+{
+    dll_node_t *n;
+
+    for (n = list->head; n; n = n->next)
+    {
+        free(n->skip);
+        n->skip = NULL;
+    }
+}
+
+/**
+ * Takes a node from the pool. Recycled nodes are preferred,
+ * otherwise the node is carved from the current chunk.
+ *
+ * @param dll_pool_t *pool: pointer to the pool
+ * @return dll_node_t*: pointer to the node
+ */
+dll_node_t* dll_poolAlloc(dll_pool_t *pool)
+{
+    assert(pool);
+
+    dll_node_t *node = pool->free;
+
+    if (node)
+    {
+        pool->free = node->next;
+        return node;
+    }
+
+    if (!pool->left && !dll_poolGrow(pool, pool->chunkNodes))
+        return NULL;
+
+    pool->left--;
+
+    return pool->unused++;
+}
+
+/**
+ * Adds a new chunk to the pool, its nodes are carved from unused.
+ * The unused nodes of the previous chunk are given up.
+ *
+ * @param dll_pool_t *pool: pointer to the pool
+ * @param unsigned long nodes: number of nodes of the chunk
+ * @return int: success
+ */
+short int dll_poolGrow(dll_pool_t *pool, unsigned long nodes)
+{
+    dll_chunk_t *chunk = malloc(sizeof(dll_chunk_t) + nodes * sizeof(dll_node_t));
+
+    if (!chunk)
+        return 0;
+
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    pool->unused = chunk->nodes;
+    pool->left = nodes;
+
+    return 1;
+}
+
+/**
+ * Releases all chunks of the pool and the pool itself.
+ *
+ * @param dll_pool_t *pool: pointer to the pool
+ * @return void
+ */
+void dll_poolRelease(dll_pool_t *pool)
+{
+    assert(pool);
+
+    dll_chunk_t *chunk = pool->chunks;
+
+    while (chunk)
+    {
+        dll_chunk_t *del = chunk;
+        chunk = chunk->next;
+        free(del);
+    }
+    free(pool);
+}
+
+/**
+ * Creates a new node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the new node
+ */
+dll_node_t* dll_createNode(dll_t *list, void *data)
+{
+    assert(data);
+
+    dll_node_t *new = list->pool ? dll_poolAlloc(list->pool) : malloc(sizeof(dll_node_t));
+
+    if (new)
+    {
+        new->data = data;
+        new->prev = new->next = NULL;
+        new->owner = list;
+        new->skip = NULL;
+        DLL_STAT(list, allocs, 1);
+
+        if (list->hash && !dll_hashInsert(list, new))
+        {
+            dll_releaseNode(list, new);
+            new = NULL;
+        }
+    }
+
+    if (!new)
+    {
+        puts("ERROR: Out of memory");
+    }
+
+    return new;
+}
+
+/**
+ * Gives the memory of an unlinked node back to the pool or frees it.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *del: node to release
+ * @return void
+ */
+void dll_releaseNode(dll_t *list, dll_node_t *del)
+{
+    DLL_STAT(list, frees, 1);
+
+    del->prev = del->data = NULL;
+    del->owner = NULL;
+
+    if (list->pool)
+    {
+        del->next = list->pool->free;
+        list->pool->free = del;
+    }
+    else
+    {
+        del->next = NULL;
+        free(del);
+    }
+}
+
+/**
+ * Creates a chain of linked nodes for an array of data pointers.
+ * Either all nodes are created or none.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void **items: array of data pointers
+ * @param unsigned long n: number of data pointers, at least one
+ * @param dll_node_t **last: returns the last node of the chain
+ * @return dll_node_t*: first node of the chain, NULL if out of memory
+ */
+dll_node_t* dll_createChain(dll_t *list, void **items, unsigned long n, dll_node_t **last)
+{
+    dll_pool_t *pool = list->hash ? NULL : list->pool;
+    dll_node_t *first = NULL, *prev = NULL, *new;
+    unsigned long i;
+
+    for (i = 0; i < n; i++)
+    {
+        assert(items[i]);
+
+        /* pooled nodes are carved in a row from the chunks */
+        if (pool && !pool->free && (pool->left || dll_poolGrow(pool, pool->chunkNodes)))
+        {
+            new = pool->unused++;
+            pool->left--;
+            new->data = items[i];
+            new->next = NULL;
+            new->owner = list;
+            new->skip = NULL;
+            DLL_STAT(list, allocs, 1);
+        }
+        else
+        {
+            new = dll_createNode(list, items[i]);
+        }
+
+        if (!new)
+        {
+            while (prev)
+            {
+                new = prev;
+                prev = prev->prev;
+                if (list->hash)
+                    dll_hashRemove(list, new);
+                dll_releaseNode(list, new);
+            }
+            return NULL;
+        }
+
+        new->prev = prev;
+        if (prev)
+            prev->next = new;
+        else
+            first = new;
+        prev = new;
+    }
+
+    *last = prev;
+
+    return first;
+}
+
+/**
+ * Creates a new node and links it after a specific node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *prev: node to add after, NULL to add as head
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the new node
+ */
+dll_node_t* dll_insert(dll_t *list, dll_node_t *prev, void *data)
+{
+    dll_node_t *new = dll_createNode(list, data);
+
+    if (new)
+    {
+        new->prev = prev;
+        new->next = prev ? prev->next : list->head;
+
+        if (new->next)
+            new->next->prev = new;
+        else
+            list->tail = new;
+
+        if (prev)
+            prev->next = new;
+        else
+            list->head = new;
+
+        list->size++;
+        DLL_STAT(list, ops[DLL_OP_INSERT], 1);
+
+        if (list->index)
+            dll_skipInsert(list, new);
+
+        if (list->sorted && !dll_inOrder(list, new, new))
+            list->sorted = 0;
+    }
+
+    return new;
+}
+
+/**
+ * Sets the node at the index to a specific value.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long index: index
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the pushed node
+za */
+dll_node_t* dll_set(dll_t *list, unsigned long index, void *data)
+{
+    assert(data);
+
+    list->curr = dll_get(list, index);
+
+    if (list->hash)
+    {
+        dll_hashRemove(list, list->curr);
+        list->curr->data = data;
+        dll_hashInsert(list, list->curr);
+    }
+    else
+    {
+        list->curr->data = data;
+    }
+
+    if (list->sorted && !dll_inOrder(list, list->curr, list->curr))
+        list->sorted = 0;
+
+    return list->curr;
+}
+
+/**
+ * Pushs a new node to the head of the doubly linked list.
+ * Sets the current node to the new node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the pushed node
+ */
+dll_node_t* dll_pushHead(dll_t *list, void *data)
+{
+    assert(list);
+    assert(data);
+
+    return list->curr = dll_insert(list, NULL, data);
+}
+
+/**
+ * Pushs a new node to the tail of the doubly linked list.
+ * Sets the current node to the new node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the pushed node
+ */
+dll_node_t* dll_pushTail(dll_t *list, void *data)
+{
+    assert(list);
+    assert(data);
+
+    return list->curr = dll_insert(list, list->tail, data);
+}
+
+/**
+ * Pushs an array of data pointers to the head of the doubly linked list,
+ * keeping their order. The nodes are created as a chain, which is linked
+ * in at once. Sets the current node to the first new node.
+ * With the skip index the new nodes are added to it one by one, in
+ * O(n log n) for n new nodes, independent of the size of the list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void **items: array of data pointers
+ * @param unsigned long n: number of data pointers
+ * @return int: success
+ */
+short int dll_pushHeadBulk(dll_t *list, void **items, unsigned long n)
+{
+    assert(list);
+    assert(items || !n);
+
+    dll_node_t *first, *last, *node;
+
+    if (!n)
+        return 1;
+
+    first = dll_createChain(list, items, n, &last);
+
+    if (!first)
+        return 0;
+
+    last->next = list->head;
+    if (list->head)
+        list->head->prev = last;
+    else
+        list->tail = last;
+    list->head = list->curr = first;
+    list->size += n;
+    DLL_STAT(list, ops[DLL_OP_INSERT], n);
+
+    /* the prefix is indexed in order, each node after indexed ones */
+    if (list->index)
+        for (node = first; node != last->next; node = node->next)
+            dll_skipInsert(list, node);
+
+    if (list->sorted && !dll_inOrder(list, first, last))
+        list->sorted = 0;
+
+    return 1;
+}
+
+/**
+ * Pushs an array of data pointers to the tail of the doubly linked list.
+ * The nodes are created as a chain, which is linked in at once.
+ * Sets the current node to the last new node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void **items: array of data pointers
+ * @param unsigned long n: number of data pointers
+ * @return int: success
+ */
+short int dll_pushTailBulk(dll_t *list, void **items, unsigned long n)
+{
+    assert(list);
+    assert(items || !n);
+
+    dll_node_t *first, *last;
+
+    if (!n)
+        return 1;
+
+    first = dll_createChain(list, items, n, &last);
+
+    if (!first)
+        return 0;
+
+    first->prev = list->tail;
+    if (list->tail)
+        list->tail->next = first;
+    else
+        list->head = first;
+    list->tail = list->curr = last;
+    list->size += n;
+    DLL_STAT(list, ops[DLL_OP_INSERT], n);
+
+    if (list->index)
+        dll_skipAppend(list, first);
+
+    if (list->sorted && !dll_inOrder(list, first, last))
+        list->sorted = 0;
+
+    return 1;
+}
+
+/**
+ * Adds a new node before a specific node.
+ * Sets the current node to the new node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *node: node to add before
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the added node
+ */
+dll_node_t* dll_addBefore(dll_t *list, dll_node_t *node, void *data)
+{
+    assert(list);
+    assert(node);
+    assert(data);
+    assert(dll_contains(list, node));
+
+    return list->curr = dll_insert(list, node->prev, data);
+}
+
+/**
+ * Adds a new node after a specific node.
+ * Sets the current node to the new node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_node_t *node: node to add after
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the added node
+ */
+dll_node_t* dll_addAfter(dll_t *list, dll_node_t *node, void *data)
+{
+    assert(list);
+    assert(node);
+    assert(data);
+    assert(dll_contains(list, node));
+
+    return list->curr = dll_insert(list, node, data);
+}
+
+/**
+ * Inserts a new node at its position in a list in sorted mode, after
+ * the nodes with equal data, in O(log n) through the skip index.
+ * Sets the current node to the new node.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the inserted node
+ */
+dll_node_t* dll_insertSorted(dll_t *list, void *data)
+{
+    assert(list);
+    assert(list->sorted);
+    assert(list->index);
+    assert(data);
+
+    return list->curr = dll_insert(list, dll_sortedLocate(list, data, 1), data);
+}
+
+/**
+ * Frees data and the node from memory. Like with dll_clear, the data
+ * is only freed if freeFn is registered.
+ *
+ * @param dll_node_t *node: node to free
+ * @return void
+ */
+void dll_freeNode(dll_t *list, dll_node_t *del)
+{
+    assert(list);
+
+    if (del && list->size)
+    {
+        if (list->compact && list->compact->cursor == del)
+            list->compact->cursor = del->next;
+
+        if (list->index)
+            dll_skipRemove(list, del);
+
+        if (list->head == list->tail)
+            list->head = list->tail = NULL;
+        else if (del == list->head)
+        {
+            list->head = del->next;
+            list->head->prev = NULL;
+        }
+        else if (del == list->tail)
+        {
+            list->tail = del->prev;
+            list->tail->next = NULL;
+        }
+        else
+        {
+            del->prev->next = del->next;
+            del->next->prev = del->prev;
+        }
+
+        if (del == list->curr)
+            list->curr = NULL;
+
+        if (list->hash)
+            dll_hashRemove(list, del);
+
+        if (list->freeFn)
+            list->freeFn(del->data);
+
+        dll_releaseNode(list, del);
+
+        list->size--;
+        DLL_STAT(list, ops[DLL_OP_DELETE], 1);
+    }
+}
+
+/**
+ * Deletes the node at the specific index.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long index: index
+ * @return void
+ */
+void dll_delete(dll_t *list, unsigned long index)
+{
+    dll_freeNode(list, dll_get(list, index));
+}
+
+/**
+ * Deletes the first node with the specific data from the list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param void *data: data pointer
+ * @param int mode: search mode
+ * @return void
+ */
+void dll_searchAndDelete(dll_t *list, void *data, short int mode)
+{
+    assert(list);
+    assert(data);
+
+    dll_node_t *found = dll_search(list, data, mode);
+
+    if (found)
+    {
+        dll_freeNode(list, found);
+    }
+}
+
+/**
+ * Deletes the first node of the doubly linked list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_popHead(dll_t *list)
+{
+    assert(list);
+
+    dll_freeNode(list, list->head);
+}
+
+/**
+ * Deletes the last node of the doubly linked list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_popTail(dll_t *list)
+{
+    assert(list);
+
+    dll_freeNode(list, list->tail);
+}
+
+/**
+ * Destroys the whole list and frees it from memory.
+ * Pooled nodes are not freed one by one, their chunks are released at once.
+ * The data is freed with freeFn, without a registered freeFn the data
+ * is left to the caller.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_clear(dll_t *list)
+{
+    if (list)
+    {
+        dll_node_t *n = list->head;
+
+        dll_disableIndex(list);
+
+        if (list->hash)
+        {
+            free(list->hash->slots);
+            free(list->hash);
+            list->hash = NULL;
+        }
+
+        if (list->pool && list->pool->refs == 1)
+        {
+            while (n && list->freeFn)
+            {
+                list->freeFn(n->data);
+                n = n->next;
+            }
+            dll_poolRelease(list->pool);
+        }
+        else if (list->pool)
+        {
+            /* other lists still use the pool, the nodes are recycled */
+            while (n)
+            {
+                dll_node_t *del = n;
+                n = n->next;
+                if (list->freeFn)
+                    list->freeFn(del->data);
+                dll_releaseNode(list, del);
+            }
+            list->pool->refs--;
+        }
+        else
+        {
+            /* the whole list goes away, so the nodes are not unlinked */
+            while (n)
+            {
+                dll_node_t *del = n;
+                n = n->next;
+                if (list->freeFn)
+                    list->freeFn(del->data);
+                free(del);
+            }
+        }
+        free(list->compact);
+        free(list);
+    }
+}
+
+/**
+ * Destroys the whole list like dll_clear, but in the background.
+ * The list is handed over in O(1) to a reclaimer thread, which frees
+ * the nodes and the data later on, so freeFn has to be thread-safe.
+ * Like with dll_clear, the data is only freed if freeFn is registered.
+ * The list must not be used anymore after the call.
+ * Lists sharing their pool with other lists, and lists that cannot be
+ * queued, are cleared right away.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_clearDeferred(dll_t *list)
+{
+    if (list)
+    {
+        dll_retired_t *retired = NULL;
+
+        /* the free list of a shared pool is not thread-safe */
+        if (!list->pool || list->pool->refs == 1)
+            retired = malloc(sizeof(dll_retired_t));
+
+        if (retired)
+        {
+            retired->next = NULL;
+            retired->list = list;
+
+            pthread_mutex_lock(&dll_reclaimLock);
+
+            if (!dll_reclaimRunning)
+            {
+                pthread_t thread;
+
+                if (pthread_create(&thread, NULL, dll_reclaimer, NULL) == 0)
+                {
+                    pthread_detach(thread);
+                    dll_reclaimRunning = 1;
+                }
+            }
+
+            if (dll_reclaimRunning)
+            {
+                if (dll_retiredTail)
+                    dll_retiredTail->next = retired;
+                else
+                    dll_retiredHead = retired;
+                dll_retiredTail = retired;
+                dll_reclaimPending++;
+
+                pthread_cond_signal(&dll_reclaimWork);
+                list = NULL;
+            }
+
+            pthread_mutex_unlock(&dll_reclaimLock);
+
+            if (list)
+                free(retired);
+        }
+
+        dll_clear(list);
+    }
+}
+
+/**
+ * Waits until the reclaimer thread has cleared all lists handed to
+ * dll_clearDeferred so far, e.g. before the program exits.
+ *
+ * @param void
+ * @return void
+ */
+void dll_reclaimWait(void)
+{
+    pthread_mutex_lock(&dll_reclaimLock);
+
+    while (dll_reclaimPending)
+        pthread_cond_wait(&dll_reclaimDone, &dll_reclaimLock);
+
+    pthread_mutex_unlock(&dll_reclaimLock);
+}
+
+/**
+ * Reclaimer thread: clears the queued lists one after another.
+ *
+ * @param void *arg: unused
+ * @return void*: never returns
+ */
+void* dll_reclaimer(void *arg)
+{
+    dll_retired_t *retired;
+
+    pthread_mutex_lock(&dll_reclaimLock);
+
+    for (;;)
+    {
+        while (!dll_retiredHead)
+            pthread_cond_wait(&dll_reclaimWork, &dll_reclaimLock);
+
+        retired = dll_retiredHead;
+        dll_retiredHead = retired->next;
+        if (!dll_retiredHead)
+            dll_retiredTail = NULL;
+
+        pthread_mutex_unlock(&dll_reclaimLock);
+
+        dll_clear(retired->list);
+        free(retired);
+
+        pthread_mutex_lock(&dll_reclaimLock);
+
+        if (--dll_reclaimPending == 0)
+            pthread_cond_broadcast(&dll_reclaimDone);
+    }
+
+    return NULL;
+}
+
+/**
+ * Compacts the list: the nodes are moved into one contiguous block in
+ * list order, so traversals read the memory sequentially again. The
+ * links, the current node and the indexes are updated, the data stays.
+ * Pointers to the nodes, e.g. in iterators, become invalid.
+ *
+ * The block is a new chunk of the pool of the list, the old nodes go to
+ * the free list of the pool. Lists without a pool are not compacted,
+ * their nodes are malloced one by one and a pool would make them
+ * incompatible with the other lists without one for dll_splice.
+ * Lists already in order are left as is.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return int: success, 0 if the list has no pool or out of memory
+ */
+short int dll_compact(dll_t *list)
+{
+    assert(list);
+
+    if (!list->compact && !dll_compactBegin(list))
+        return 0;
+
+    if (list->compact)
+        dll_compactMove(list, list->size);
+
+    return 1;
+}
+
+/**
+ * Compacts the list incrementally like dll_compact: every step moves at
+ * most nodes nodes, so the work is spread in small slices over time.
+ * The list may be used and modified between the steps. Nodes inserted
+ * meanwhile before the position of the compaction stay where they are.
+ * Only the moved nodes become invalid. Like dll_compact, lists without
+ * a pool are not compacted.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long nodes: maximum number of nodes to move
+ * @return unsigned long: nodes left to move, 0 when finished or failed
+ */
+unsigned long dll_compactStep(dll_t *list, unsigned long nodes)
+{
+    assert(list);
+
+    if (!list->compact && (!dll_compactBegin(list) || !list->compact))
+        return 0;
+
+    return dll_compactMove(list, nodes);
+}
+
+/**
+ * Starts a compaction: adds a chunk for all nodes of the list to its
+ * pool. Nothing is started if every node already follows its previous
+ * node in memory.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return int: success, 0 if the list has no pool or out of memory
+ */
+short int dll_compactBegin(dll_t *list)
+{
+    dll_compact_t *compact;
+    dll_chunk_t *chunk;
+    dll_pool_t *pool = list->pool;
+    dll_node_t *n = list->head;
+
+    if (!pool)
+        return 0;
+
+    while (n && (!n->next || n->next == n + 1))
+        n = n->next;
+
+    if (!n)
+        return 1;
+
+    compact = malloc(sizeof(dll_compact_t));
+    chunk = malloc(sizeof(dll_chunk_t) + list->size * sizeof(dll_node_t));
+
+    if (!compact || !chunk)
+    {
+        puts("ERROR: Out of memory");
+        free(compact);
+        free(chunk);
+        return 0;
+    }
+
+    /* the chunk is not carved by the pool, only released with it */
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    compact->nodes = chunk->nodes;
+    compact->used = 0;
+    compact->capacity = list->size;
+    compact->cursor = list->head;
+
+    list->compact = compact;
+
+    return 1;
+}
+
+/**
+ * Moves the next nodes of a compaction into the chunk, one after another.
+ * Ends the compaction when the tail is reached or the chunk is full.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long nodes: maximum number of nodes to move
+ * @return unsigned long: nodes left to move, 0 when finished
+ */
+unsigned long dll_compactMove(dll_t *list, unsigned long nodes)
+{
+    dll_compact_t *compact = list->compact;
+    dll_node_t *old, *new;
+
+    while (nodes-- && compact->cursor && compact->used < compact->capacity)
+    {
+        old = compact->cursor;
+        new = &compact->nodes[compact->used++];
+        *new = *old;
+        compact->cursor = old->next;
+
+        if (new->prev)
+            new->prev->next = new;
+        else
+            list->head = new;
+
+        if (new->next)
+            new->next->prev = new;
+        else
+            list->tail = new;
+
+        if (list->curr == old)
+            list->curr = new;
+        if (new->skip)
+            new->skip->node = new;
+        if (list->hash)
+            dll_hashReplace(list, old, new);
+
+        old->data = old->prev = NULL;
+        old->owner = NULL;
+        old->skip = NULL;
+        old->next = list->pool->free;
+        list->pool->free = old;
+    }
+
+    if (compact->cursor && compact->used < compact->capacity)
+        return compact->capacity - compact->used;
+
+    free(compact);
+    list->compact = NULL;
+
+    return 0;
+}
+
+/**
+ * Moves the nodes from first to last of the list src before the node pos
+ * of the list dst. The nodes are relinked without allocating or freeing
+ * anything. The moved nodes are counted and tagged with their new owner,
+ * hash indexes are updated per moved node, skip indexes are rebuilt
+ * unless the nodes are appended.
+ * Both lists have to allocate their nodes the same way, see
+ * dll_createSharingPool for pooled lists.
+ *
+ * @param dll_t *dst: pointer to the destination list
+ * @param dll_node_t *pos: node of dst to move before, NULL to append
+ * @param dll_t *src: pointer to the source list
+ * @param dll_node_t *first: first node of the range
+ * @param dll_node_t *last: last node of the range
+ * @return int: success
+ */
+short int dll_splice(dll_t *dst, dll_node_t *pos, dll_t *src, dll_node_t *first, dll_node_t *last)
+{
+    assert(dst);
+    assert(src);
+    assert(dst != src);
+    assert(dst->pool == src->pool);
+    assert(dll_contains(src, first));
+    assert(dll_contains(src, last));
+    assert(!pos || dll_contains(dst, pos));
+
+    dll_node_t *n, *prev;
+    unsigned long count = 1;
+
+    if (dst->hash)
+    {
+        for (n = first; n != last; n = n->next)
+            count++;
+
+        if (!dll_hashReserve(dst->hash, count))
+        {
+            puts("ERROR: Out of memory");
+            return 0;
+        }
+    }
+
+    count = 0;
+
+    for (n = first; ; n = n->next)
+    {
+        count++;
+
+        if (src->hash)
+            dll_hashRemove(src, n);
+        if (dst->hash)
+            dll_hashInsert(dst, n);
+        if (n == src->curr)
+            src->curr = NULL;
+        if (src->compact && n == src->compact->cursor)
+            src->compact->cursor = last->next;
+
+        free(n->skip);
+        n->skip = NULL;
+        n->owner = dst;
+
+        if (n == last)
+            break;
+    }
+
+    if (first->prev)
+        first->prev->next = last->next;
+    else
+        src->head = last->next;
+
+    if (last->next)
+        last->next->prev = first->prev;
+    else
+        src->tail = first->prev;
+
+    src->size -= count;
+
+    prev = pos ? pos->prev : dst->tail;
+    first->prev = prev;
+    last->next = pos;
+
+    if (prev)
+        prev->next = first;
+    else
+        dst->head = first;
+
+    if (pos)
+        pos->prev = last;
+    else
+        dst->tail = last;
+
+    dst->size += count;
+    DLL_STAT(dst, ops[DLL_OP_SPLICE], 1);
+
+    if (dst->sorted && !dll_inOrder(dst, first, last))
+        dst->sorted = 0;
+
+    if (src->index)
+        dll_skipBuild(src);
+
+    if (dst->index && pos)
+        dll_skipBuild(dst);
+    else if (dst->index)
+        dll_skipAppend(dst, first);
+
+    return 1;
+}
+
+/**
+ * Moves all nodes of the list src to the tail of the list dst.
+ * The links are changed in O(1), but every moved node is retagged with
+ * its new owner (and moved between the hash indexes), so this takes
+ * O(n) in the size of src. The skip index of dst is extended.
+ *
+ * @param dll_t *dst: pointer to the destination list
+ * @param dll_t *src: pointer to the source list, which is empty afterwards
+ * @return int: success
+ */
+short int dll_concat(dll_t *dst, dll_t *src)
+{
+    assert(src);
+
+    if (!src->head)
+        return 1;
+
+    return dll_splice(dst, NULL, src, src->head, src->tail);
+}
+
+/**
+ * Splits the list at the index. The nodes from the index to the tail
+ * are moved to a new list, which shares the pool, the callbacks and
+ * the kind of indexes with the list. With the index equal to the size
+ * the new list is empty.
+ * Like dll_concat this takes O(n) in the number of moved nodes to
+ * retag them, plus locating the index and rebuilding the skip index.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long index: index of the first node to move
+ * @return dll_t*: pointer of the new list, NULL if out of memory
+ */
+dll_t* dll_splitAt(dll_t *list, unsigned long index)
+{
+    assert(list);
+    assert(index <= list->size);
+
+    dll_t *new = dll_createSharingPool(list);
+
+    if (new)
+    {
+        new->sorted = list->sorted;
+
+        if ((list->hash && !dll_registerHashFn(new, list->hashFn))
+            || (list->index && !dll_enableIndex(new))
+            || (index < list->size && !dll_splice(new, NULL, list, dll_locate(list, index), list->tail)))
+        {
+            dll_clear(new);
+            new = NULL;
+        }
+    }
+
+    return new;
+}
+
+/**
+ * Reverses the list.
+ * The links of the nodes are swapped, the nodes keep their data.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_reverse(dll_t *list)
+{
+    assert(list);
+
+    dll_node_t *n = list->head, *tmp;
+
+    DLL_STAT(list, ops[DLL_OP_REVERSE], 1);
+
+    while (n)
+    {
+        tmp = n->next;
+        n->next = n->prev;
+        n->prev = tmp;
+        n = tmp;
+    }
+
+    tmp = list->head;
+    list->head = list->tail;
+    list->tail = tmp;
+
+    if (list->sorted && list->size > 1)
+        list->sorted = dll_inOrder(list, list->head, list->tail);
+
+    if (list->index)
+        dll_skipBuild(list);
+}
+
+/**
+ * Sorts a chain of nodes with a bottom-up merge sort.
+ *
+ * The nodes are relinked, their data pointers are left untouched. Runs of
+ * width 1, 2, 4, ... are merged until a single run remains. On equal data
+ * the node of the left run is taken first, which keeps the sort stable.
+ *
+ * @param dll_t *list: pointer to the doubly linked list (provides compareFn)
+ * @param dll_node_t *head: first node of the NULL terminated chain
+ * @param dll_node_t **tail: returns the last node of the sorted chain
+ * @return dll_node_t*: first node of the sorted chain
+ */
+dll_node_t* dll_mergeSort(dll_t *list, dll_node_t *head, dll_node_t **tail)
+{
+    unsigned long width = 1, merges;
+    dll_node_t *p, *q, *e, *last;
+
+    if (!head)
+    {
+        *tail = NULL;
+        return NULL;
+    }
+
+    do
+    {
+        p = head;
+        head = last = NULL;
+        merges = 0;
+
+        while (p)
+        {
+            unsigned long psize = 0, qsize = width;
+
+            merges++;
+            q = p;
+            while (psize < width && q)
+            {
+                psize++;
+                q = q->next;
+            }
+
+            while (psize || (qsize && q))
+            {
+                if (!psize)
+                {
+                    e = q;
+                    q = q->next;
+                    qsize--;
+                }
+                else if (!qsize || !q || DLL_COMPARE(list, p->data, q->data) <= 0)
+                {
+                    e = p;
+                    p = p->next;
+                    psize--;
+                }
+                else
+                {
+                    e = q;
+                    q = q->next;
+                    qsize--;
+                }
+
+                if (last)
+                    last->next = e;
+                else
+                    head = e;
+                e->prev = last;
+                last = e;
+            }
+
+            p = q;
+        }
+
+        last->next = NULL;
+        width *= 2;
+    }
+    while (merges > 1);
+
+    *tail = last;
+
+    return head;
+}
+
+/**
+ * Sorts the list with a stable merge sort in O(n log n).
+ *
+ * The order of the nodes is defined through the compareFn function.
+ * The nodes are relinked instead of swapping their data, thus node
+ * pointers held by the caller still point to the same data afterwards.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_sort(dll_t *list)
+{
+    assert(list);
+    assert(list->compareFn);
+
+    DLL_STAT(list, ops[DLL_OP_SORT], 1);
+
+    list->head = dll_mergeSort(list, list->head, &list->tail);
+
+    if (list->index)
+        dll_skipBuild(list);
+}
+
+/**
+ * Sorts the list like dll_sort, but with up to threads threads.
+ *
+ * The list is cut into one run per thread, the runs are sorted
+ * concurrently and merged pairwise in rounds, again concurrently.
+ * The nodes are relinked, the sort is stable. compareFn is called from
+ * several threads at once, so it must not modify shared state.
+ * Falls back to dll_sort for short lists or if no memory is available.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned int threads: maximum number of threads
+ * @return void
+ */
+void dll_sortParallel(dll_t *list, unsigned int threads)
+{
+    assert(list);
+    assert(list->compareFn);
+
+    dll_sortRun_t *runs = NULL;
+    dll_node_t *n = list->head;
+    unsigned long per, i;
+    unsigned int t, step;
+
+    if (threads > list->size / DLL_SORT_GRAIN)
+        threads = list->size / DLL_SORT_GRAIN;
+
+    if (threads > 1)
+        runs = malloc(threads * sizeof(dll_sortRun_t));
+
+    if (!runs)
+    {
+        dll_sort(list);
+        return;
+    }
+
+    DLL_STAT(list, ops[DLL_OP_SORT], 1);
+    per = list->size / threads;
+
+    for (t = 0; t < threads; t++)
+    {
+        runs[t].list = list;
+        runs[t].head = n;
+        runs[t].other = NULL;
+
+        if (t == threads - 1)
+        {
+            runs[t].tail = list->tail;
+        }
+        else
+        {
+            for (i = 1; i < per; i++)
+                n = n->next;
+
+            runs[t].tail = n;
+            n = n->next;
+            n->prev = NULL;
+            runs[t].tail->next = NULL;
+        }
+    }
+
+    dll_sortRuns(runs, threads, dll_sortWorker, 0);
+
+    for (step = 1; step < threads; step *= 2)
+        dll_sortRuns(runs, threads, dll_mergeWorker, step);
+
+    list->head = runs[0].head;
+    list->tail = runs[0].tail;
+    free(runs);
+
+    if (list->index)
+        dll_skipBuild(list);
+}
+
+/**
+ * Runs a sort or merge worker for every run that takes part in a round,
+ * the first one in the calling thread. With a step the run i + step is
+ * merged into the run i for every multiple i of 2 * step. A worker whose
+ * thread cannot be started runs in the calling thread.
+ *
+ * @param dll_sortRun_t *runs: array of runs
+ * @param unsigned int threads: number of runs
+ * @param void* (*worker)(void*): dll_sortWorker or dll_mergeWorker
+ * @param unsigned int step: distance of merged runs, 0 to sort them
+ * @return void
+ */
+void dll_sortRuns(dll_sortRun_t *runs, unsigned int threads, void* (*worker)(void*), unsigned int step)
+{
+    pthread_t thread[threads];
+    short int started[threads];
+    unsigned int t, stride = step ? 2 * step : 1;
+
+    for (t = stride; t < threads; t += stride)
+    {
+        started[t] = 0;
+
+        if (step)
+        {
+            if (t + step >= threads)
+                continue;
+            runs[t].other = &runs[t + step];
+        }
+
+        started[t] = pthread_create(&thread[t], NULL, worker, &runs[t]) == 0;
+        if (!started[t])
+            worker(&runs[t]);
+    }
+
+    if (step)
+        runs[0].other = &runs[step];
+    worker(&runs[0]);
+
+    for (t = stride; t < threads; t += stride)
+        if (started[t])
+            pthread_join(thread[t], NULL);
+}
+
+/**
+ * Sorts one run.
+ *
+ * @param void *arg: the run
+ * @return void*: NULL
+ */
+void* dll_sortWorker(void *arg)
+{
+    dll_sortRun_t *run = arg;
+
+    run->head = dll_mergeSort(run->list, run->head, &run->tail);
+
+    return NULL;
+}
+
+/**
+ * Merges the run other into the run, stable, so on equal
+ * data the nodes of the run come first.
+ *
+ * @param void *arg: the run
+ * @return void*: NULL
+ */
+void* dll_mergeWorker(void *arg)
+{
+    dll_sortRun_t *run = arg;
+    dll_node_t *p = run->head, *q = run->other->head;
+    dll_node_t *e, *last = NULL;
+
+    while (p && q)
+    {
+        if (DLL_COMPARE(run->list, p->data, q->data) <= 0)
+        {
+            e = p;
+            p = p->next;
+        }
+        else
+        {
+            e = q;
+            q = q->next;
+        }
+
+        if (last)
+            last->next = e;
+        else
+            run->head = e;
+        e->prev = last;
+        last = e;
+    }
+
+    e = p ? p : q;
+    last->next = e;
+    e->prev = last;
+
+    if (!p)
+        run->tail = run->other->tail;
+
+    run->other = NULL;
+
+    return NULL;
+}
+
+/**
+ * Sorts the list by integer keys in O(n).
+ *
+ * The key of every node is extracted once with keyFn, so the data is
+ * not touched again while sorting. The keys are sorted with a stable
+ * LSD radix sort as unsigned numbers, signed keys have to be mapped
+ * by flipping their sign bit. The nodes are relinked afterwards.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long long (*keyFn)(void*): returns the key of the data
+ * @return int: success
+ */
+short int dll_sortByKey(dll_t *list, unsigned long long (*keyFn)(void*) )
+{
+    assert(list);
+    assert(keyFn);
+
+    dll_keyed_t *keyed;
+    dll_node_t *n;
+    unsigned long i = 0;
+
+    if (list->size < 2)
+        return 1;
+
+    keyed = malloc(2 * list->size * sizeof(dll_keyed_t));
+
+    if (!keyed)
+    {
+        puts("ERROR: Out of memory");
+        return 0;
+    }
+
+    for (n = list->head; n; n = n->next, i++)
+    {
+        keyed[i].key = keyFn(n->data);
+        keyed[i].node = n;
+    }
+
+    DLL_STAT(list, ops[DLL_OP_SORT], 1);
+    dll_relink(list, dll_radixSort(keyed, keyed + list->size, list->size));
+    free(keyed);
+
+    return 1;
+}
+
+/**
+ * Sorts the list by an integer stored in the data, in O(n).
+ *
+ * Like dll_sortByKey, but the key is read directly at offset bytes into
+ * the data (e.g. offsetof of a struct member), so no function is called
+ * per node. Signed keys are mapped to unsigned ones by flipping their
+ * sign bit, 32 bit keys need only half the passes of 64 bit keys.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long offset: offset of the key in the data
+ * @param dll_keyType_t type: DLL_KEY_I32, DLL_KEY_U32, DLL_KEY_I64 or DLL_KEY_U64
+ * @return int: success
+ */
+short int dll_sortByIntKey(dll_t *list, unsigned long offset, dll_keyType_t type)
+{
+    assert(list);
+
+    dll_keyed_t *keyed;
+    dll_node_t *n;
+    unsigned long i = 0;
+
+    if (list->size < 2)
+        return 1;
+
+    keyed = malloc(2 * list->size * sizeof(dll_keyed_t));
+
+    if (!keyed)
+    {
+        puts("ERROR: Out of memory");
+        return 0;
+    }
+
+    for (n = list->head; n; n = n->next, i++)
+    {
+        char *key = (char*)n->data + offset;
+
+        switch (type)
+        {
+            case DLL_KEY_I32:
+                keyed[i].key = (uint32_t)*(int32_t*)key ^ 0x80000000u;
+                break;
+            case DLL_KEY_U32:
+                keyed[i].key = *(uint32_t*)key;
+                break;
+            case DLL_KEY_I64:
+                keyed[i].key = (uint64_t)*(int64_t*)key ^ 0x8000000000000000ull;
+                break;
+            default:
+                keyed[i].key = *(uint64_t*)key;
+                break;
+        }
+        keyed[i].node = n;
+    }
+
+    DLL_STAT(list, ops[DLL_OP_SORT], 1);
+    dll_relink(list, dll_radixSort(keyed, keyed + list->size, list->size));
+    free(keyed);
+
+    return 1;
+}
+
+/**
+ * Moves the k smallest nodes, as defined through the compareFn function,
+ * into a new list in ascending order in O(n log k). Equal nodes keep
+ * their order. The other nodes stay in the list in their order.
+ * The new list shares the pool, the callbacks and the kind of indexes
+ * with the list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long k: number of nodes to move
+ * @return dll_t*: pointer of the new list, NULL if out of memory
+ */
+dll_t* dll_topK(dll_t *list, unsigned long k)
+{
+    assert(list);
+    assert(list->compareFn);
+
+    dll_t *new = dll_createSharingPool(list);
+    dll_keyed_t *heap = NULL;
+    dll_node_t *n = list->head;
+    unsigned long i;
+
+    if (k > list->size)
+        k = list->size;
+
+    if (!new)
+        return NULL;
+
+    new->sorted = list->sorted;
+
+    if (k)
+        heap = malloc(k * sizeof(dll_keyed_t));
+
+    if ((k && !heap)
+        || (list->hash && !dll_registerHashFn(new, list->hashFn))
+        || (new->hash && !dll_hashReserve(new->hash, k)))
+    {
+        puts("ERROR: Out of memory");
+        free(heap);
+        dll_clear(new);
+        return NULL;
+    }
+
+    /* max heap of the k smallest nodes seen so far */
+    for (i = 0; n; n = n->next, i++)
+    {
+        dll_keyed_t candidate = { i, n };
+
+        if (i < k)
+        {
+            heap[i] = candidate;
+            if (i == k - 1)
+            {
+                unsigned long j;
+                for (j = k / 2; j-- > 0; )
+                    dll_heapSift(list, heap, k, j);
+            }
+        }
+        else if (k && dll_rankCompare(list, &candidate, &heap[0]) < 0)
+        {
+            heap[0] = candidate;
+            dll_heapSift(list, heap, k, 0);
+        }
+    }
+
+    for (i = k; i-- > 1; )
+    {
+        dll_keyed_t swap = heap[0];
+        heap[0] = heap[i];
+        heap[i] = swap;
+        dll_heapSift(list, heap, i, 0);
+    }
+
+    if (list->index)
+    {
+        short int sorted = list->sorted;
+
+        /* the index of the list is rebuilt once instead of per node */
+        dll_disableIndex(list);
+
+        for (i = 0; i < k; i++)
+            dll_splice(new, NULL, list, heap[i].node, heap[i].node);
+
+        list->sorted = dll_enableIndex(list) && sorted;
+        new->sorted = dll_enableIndex(new) && new->sorted;
+    }
+    else
+    {
+        for (i = 0; i < k; i++)
+            dll_splice(new, NULL, list, heap[i].node, heap[i].node);
+    }
+
+    free(heap);
+
+    return new;
+}
+
+/**
+ * Returns the node which would be at the index if the list was sorted,
+ * as defined through the compareFn function, with a quickselect in O(n)
+ * on average. The list is not changed.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long index: position in sorted order
+ * @return dll_node_t*: the node, NULL if out of memory
+ */
+dll_node_t* dll_nthElement(dll_t *list, unsigned long index)
+{
+    assert(list);
+    assert(list->compareFn);
+    assert(index < list->size);
+
+    dll_node_t **nodes = malloc(list->size * sizeof(dll_node_t*));
+    dll_node_t *n, *found;
+    unsigned long lo = 0, hi = list->size - 1, i;
+
+    if (!nodes)
+    {
+        puts("ERROR: Out of memory");
+        return NULL;
+    }
+
+    for (n = list->head, i = 0; n; n = n->next, i++)
+        nodes[i] = n;
+
+    while (lo < hi)
+    {
+        /* median of three as pivot, then a three way partition */
+        unsigned long mid = lo + (hi - lo) / 2, lt = lo, gt = hi;
+        void *a = nodes[lo]->data, *b = nodes[mid]->data, *c = nodes[hi]->data;
+        void *pivot;
+
+        if (DLL_COMPARE(list, a, b) < 0)
+            pivot = DLL_COMPARE(list, b, c) < 0 ? b : (DLL_COMPARE(list, a, c) < 0 ? c : a);
+        else
+            pivot = DLL_COMPARE(list, a, c) < 0 ? a : (DLL_COMPARE(list, b, c) < 0 ? c : b);
+
+        i = lo;
+        while (i <= gt)
+        {
+            int cmp = DLL_COMPARE(list, nodes[i]->data, pivot);
+            dll_node_t *swap = nodes[i];
+
+            if (cmp < 0)
+            {
+                nodes[i++] = nodes[lt];
+                nodes[lt++] = swap;
+            }
+            else if (cmp > 0)
+            {
+                nodes[i] = nodes[gt];
+                nodes[gt] = swap;
+                if (!gt--)
+                    break;
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        if (index < lt)
+            hi = lt - 1;
+        else if (index > gt)
+            lo = gt + 1;
+        else
+            lo = hi = index;
+    }
+
+    found = nodes[index];
+    free(nodes);
+
+    return found;
+}
+
+/**
+ * Compares two ranked nodes through the compareFn function,
+ * equal nodes by their position.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_keyed_t *a: ranked node
+ * @param dll_keyed_t *b: ranked node
+ * @return int: <0, 0 or >0
+ */
+int dll_rankCompare(dll_t *list, dll_keyed_t *a, dll_keyed_t *b)
+{
+    int cmp = DLL_COMPARE(list, a->node->data, b->node->data);
+
+    if (cmp)
+        return cmp;
+
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+/**
+ * Moves the element at i of a max heap of n ranked nodes down
+ * to its place.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_keyed_t *heap: heap array
+ * @param unsigned long n: number of elements
+ * @param unsigned long i: element to move
+ * @return void
+ */
+void dll_heapSift(dll_t *list, dll_keyed_t *heap, unsigned long n, unsigned long i)
+{
+    dll_keyed_t moved = heap[i];
+
+    for (;;)
+    {
+        unsigned long child = 2 * i + 1;
+
+        if (child >= n)
+            break;
+        if (child + 1 < n && dll_rankCompare(list, &heap[child + 1], &heap[child]) > 0)
+            child++;
+        if (dll_rankCompare(list, &heap[child], &moved) <= 0)
+            break;
+
+        heap[i] = heap[child];
+        i = child;
+    }
+
+    heap[i] = moved;
+}
+
+/**
+ * Sorts an array by key with a stable LSD radix sort, one byte per
+ * pass. The counts of all passes are taken in a single scan, passes
+ * in which all keys have the same byte are skipped.
+ *
+ * @param dll_keyed_t *keyed: array to sort
+ * @param dll_keyed_t *tmp: buffer of the same size
+ * @param unsigned long n: number of elements
+ * @return dll_keyed_t*: keyed or tmp, whichever holds the result
+ */
+dll_keyed_t* dll_radixSort(dll_keyed_t *keyed, dll_keyed_t *tmp, unsigned long n)
+{
+    unsigned long count[sizeof(unsigned long long)][256] = {{0}};
+    unsigned long i, sum;
+    unsigned int pass, b;
+
+    for (i = 0; i < n; i++)
+        for (pass = 0; pass < sizeof(unsigned long long); pass++)
+            count[pass][(keyed[i].key >> (8 * pass)) & 0xff]++;
+
+    for (pass = 0; pass < sizeof(unsigned long long); pass++)
+    {
+        unsigned long *c = count[pass];
+        dll_keyed_t *swap;
+
+        if (c[(keyed[0].key >> (8 * pass)) & 0xff] == n)
+            continue;
+
+        for (b = 0, sum = 0; b < 256; b++)
+        {
+            unsigned long cnt = c[b];
+            c[b] = sum;
+            sum += cnt;
+        }
+
+        for (i = 0; i < n; i++)
+            tmp[c[(keyed[i].key >> (8 * pass)) & 0xff]++] = keyed[i];
+
+        swap = keyed;
+        keyed = tmp;
+        tmp = swap;
+    }
+
+    return keyed;
+}
+
+/**
+ * Relinks all nodes of the list in the order of the array.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_keyed_t *keyed: array of all nodes
+ * @return void
+ */
+void dll_relink(dll_t *list, dll_keyed_t *keyed)
+{
+    dll_node_t *last = NULL;
+    unsigned long i;
+
+    for (i = 0; i < list->size; i++)
+    {
+        dll_node_t *n = keyed[i].node;
+
+        n->prev = last;
+        if (last)
+            last->next = n;
+        last = n;
+    }
+
+    last->next = NULL;
+    list->head = keyed[0].node;
+    list->tail = last;
+
+    if (list->sorted)
+        list->sorted = dll_inOrder(list, list->head, list->tail);
+
+    if (list->index)
+        dll_skipBuild(list);
+}
+
+/**
+ * Prints the list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_print(dll_t *list)
+{
+    assert(list);
+    assert(list->printFn);
+
+    printf("--- head ---\n");
+
+    dll_traverse(list, list->printFn);
+
+    printf("--- tail ---\n");
+}
+
+/**
+ * Copies the statistics of the list: the operations by type, the
+ * compareFn calls, the nodes visited by dll_get and the searches, the
+ * node allocations and frees and the latency histograms of dll_get and
+ * dll_search. The statistics are only kept if DLL_STATS is defined.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_stats_t *stats: statistics, zeroed without DLL_STATS
+ * @return int: statistics available
+ */
+short int dll_stats(dll_t *list, dll_stats_t *stats)
+{
+    assert(list);
+    assert(stats);
+
+#ifdef DLL_STATS
+    memcpy(stats, &list->stats, sizeof(dll_stats_t));
+    stats->compares = __atomic_load_n(&list->stats.compares, __ATOMIC_RELAXED);
+
+    return 1;
+#else
+    memset(stats, 0, sizeof(dll_stats_t));
+
+    return 0;
+#endif
+}
+
+/**
+ * Resets the statistics of the list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @return void
+ */
+void dll_statsReset(dll_t *list)
+{
+    assert(list);
+
+#ifdef DLL_STATS
+    memset(&list->stats, 0, sizeof(dll_stats_t));
+#endif
+}
+
+/**
+ * Returns the latency in ns below which percent of the calls recorded
+ * in a histogram of dll_stats_t completed, rounded up to the bucket.
+ *
+ * @param unsigned long long *histogram: getLatency or searchLatency
+ * @param double percent: percentile, e.g. 99.9
+ * @return unsigned long long: latency in ns, 0 if nothing is recorded
+ */
+unsigned long long dll_statsPercentile(unsigned long long *histogram, double percent)
+{
+    assert(histogram);
+
+    unsigned long long total = 0, sum = 0, target;
+    unsigned int i;
+
+    for (i = 0; i < DLL_STATS_BUCKETS; i++)
+        total += histogram[i];
+
+    if (!total)
+        return 0;
+
+    target = percent / 100 * total;
+    if (target < 1)
+        target = 1;
+
+    for (i = 0; i < DLL_STATS_BUCKETS - 1; i++)
+    {
+        sum += histogram[i];
+        if (sum >= target)
+            break;
+    }
+
+    if (i < 2 * DLL_STATS_SUB)
+        return i;
+
+    unsigned int shift = (i - 2 * DLL_STATS_SUB) / DLL_STATS_SUB + 1;
+    unsigned long long sub = (i - 2 * DLL_STATS_SUB) % DLL_STATS_SUB;
+
+    return ((DLL_STATS_SUB + sub + 1) << shift) - 1;
+}
+
+#ifdef DLL_STATS
+/**
+ * Records the time since start in a latency histogram.
+ *
+ * @param unsigned long long *histogram: histogram of dll_stats_t
+ * @param struct timespec *start: start time
+ * @return void
+ */
+void dll_statsRecord(unsigned long long *histogram, struct timespec *start)
+{
+    struct timespec end;
+    unsigned long long ns;
+    unsigned int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = (end.tv_sec - start->tv_sec) * 1000000000ULL + end.tv_nsec - start->tv_nsec;
+
+    if (ns < 2 * DLL_STATS_SUB)
+    {
+        i = ns;
+    }
+    else
+    {
+        /* the top bits of ns select the bucket within its power of two */
+        unsigned int shift = 63 - __builtin_clzll(ns) - __builtin_ctz(DLL_STATS_SUB);
+        i = 2 * DLL_STATS_SUB + (shift - 1) * DLL_STATS_SUB + (ns >> shift) - DLL_STATS_SUB;
+        if (i >= DLL_STATS_BUCKETS)
+            i = DLL_STATS_BUCKETS - 1;
+    }
+
+    histogram[i]++;
+}
+#endif
+
+/**
+ * Saves the list to a binary file, the data is written with the
+ * serializeFn function.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param const char *path: file name
+ * @return int: success
+ */
+short int dll_save(dll_t *list, const char *path)
+{
+    assert(list);
+    assert(list->serializeFn);
+    assert(path);
+
+    FILE *fp = fopen(path, "wb");
+    unsigned long size = 256, len;
+    uint64_t count = list->size;
+    char *buffer = malloc(size);
+    short int ok = 1;
+    dll_node_t *n;
+
+    if (!fp)
+    {
+        printf("ERROR: Cannot open file '%s'\n", path);
+        free(buffer);
+        return 0;
+    }
+
+    if (!buffer)
+    {
+        puts("ERROR: Out of memory");
+        fclose(fp);
+        return 0;
+    }
+
+    setvbuf(fp, NULL, _IOFBF, DLL_IO_BUFFER);
+
+    ok = fwrite(DLL_MAGIC, 4, 1, fp) && fwrite(&count, sizeof(count), 1, fp);
+
+    for (n = list->head; n && ok; n = n->next)
+    {
+        uint32_t length;
+
+        len = list->serializeFn(n->data, buffer, size);
+
+        if (len > size)
+        {
+            char *grown = realloc(buffer, len);
+
+            if (!grown)
+            {
+                puts("ERROR: Out of memory");
+                ok = 0;
+                break;
+            }
+
+            buffer = grown;
+            size = len;
+            len = list->serializeFn(n->data, buffer, size);
+        }
+
+        length = len;
+        ok = fwrite(&length, sizeof(length), 1, fp) && (!len || fwrite(buffer, len, 1, fp));
+    }
+
+    free(buffer);
+
+    if (fclose(fp) || !ok)
+    {
+        printf("ERROR: Cannot write file '%s'\n", path);
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Loads the elements of a file written by dll_save and appends them to
+ * the list. The data is created with the deserializeFn function, the
+ * nodes are created and linked in batches like dll_pushTailBulk.
+ * On failure the elements loaded so far stay in the list.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param const char *path: file name
+ * @return int: success
+ */
+short int dll_load(dll_t *list, const char *path)
+{
+    assert(list);
+    assert(list->deserializeFn);
+    assert(path);
+
+    void **items = malloc(DLL_LOAD_BATCH * sizeof(void*));
+    unsigned long size = 256;
+    char *buffer = malloc(size);
+    uint64_t left;
+    long batch = 0;
+    short int ok = 0;
+    FILE *fp;
+
+    if (!items || !buffer)
+    {
+        puts("ERROR: Out of memory");
+        free(items);
+        free(buffer);
+        return 0;
+    }
+
+    fp = dll_openFile(path, &left);
+
+    if (fp)
+    {
+        while ((batch = dll_readBatch(list, fp, &left, items, &buffer, &size)) > 0)
+        {
+            if (!dll_pushTailBulk(list, items, batch))
+            {
+                dll_freeBatch(list, items, batch);
+                batch = -1;
+                break;
+            }
+        }
+
+        if (batch < 0)
+            printf("ERROR: Cannot load file '%s'\n", path);
+
+        ok = !batch;
+        fclose(fp);
+    }
+
+    free(items);
+    free(buffer);
+
+    return ok;
 }
 
 /**
- * Creates a new node.
+ * Opens a file written by dll_save for reading and reads its header.
  *
- * @param void *data: data pointer
- * @return dll_node_t*: pointer to the new node
+ * @param const char *path: file name
+ * @param uint64_t *count: number of elements in the file
+ * @return FILE*: file positioned at the first element, NULL on failure
  */
-dll_node_t* dll_createNode(void *data)
+FILE* dll_openFile(const char *path, uint64_t *count)
 {
-    assert(data);
+    FILE *fp = fopen(path, "rb");
+    char magic[4];
 
-    dll_node_t *new = malloc(sizeof(dll_node_t));
-
-    if (new)
+    if (!fp)
     {
-        new->data = data;
-        new->prev = new->next = NULL;
+        printf("ERROR: Cannot open file '%s'\n", path);
+        return NULL;
     }
-    else
+
+    setvbuf(fp, NULL, _IOFBF, DLL_IO_BUFFER);
+
+    if (!fread(magic, 4, 1, fp) || memcmp(magic, DLL_MAGIC, 4)
+        || !fread(count, sizeof(*count), 1, fp))
     {
-        puts("ERROR: Out of memory");
+        printf("ERROR: Cannot load file '%s'\n", path);
+        fclose(fp);
+        return NULL;
     }
 
-    return new;
+    return fp;
 }
 
 /**
- * Creates the first node of the doubly linked list.
+ * Reads and deserializes the next batch of up to DLL_LOAD_BATCH elements.
+ * On failure the data read of the batch is freed.
  *
  * @param dll_t *list: pointer to the doubly linked list
- * @param void *data: data pointer
- * @return dll_node_t*: pointer to the first node
+ * @param FILE *fp: file opened by dll_openFile
+ * @param uint64_t *left: number of elements left in the file
+ * @param void **items: array for the data pointers of the batch
+ * @param char **buffer: read buffer, grown as needed
+ * @param unsigned long *size: size of the read buffer
+ * @return long: number of elements read, 0 at the end, -1 on failure
  */
-dll_node_t* dll_addFirstNode(dll_t *list, void *data)
+long dll_readBatch(dll_t *list, FILE *fp, uint64_t *left, void **items, char **buffer, unsigned long *size)
 {
-    assert(list);
-    assert(data);
+    long batch = 0;
+
+    while (*left && batch < DLL_LOAD_BATCH)
+    {
+        uint32_t length;
+
+        if (!fread(&length, sizeof(length), 1, fp))
+            break;
+
+        if (length > *size)
+        {
+            char *grown = realloc(*buffer, length);
+
+            if (!grown)
+                break;
+
+            *buffer = grown;
+            *size = length;
+        }
 
-    list->size = 1;
+        if ((length && !fread(*buffer, length, 1, fp))
+            || !(items[batch] = list->deserializeFn(*buffer, length)))
+            break;
+
+        batch++;
+        (*left)--;
+    }
+
+    if (*left && batch < DLL_LOAD_BATCH)
+    {
+        dll_freeBatch(list, items, batch);
+        return -1;
+    }
 
-    return list->head = list->tail = list->curr = dll_createNode(data);
+    return batch;
 }
 
 /**
- * Sets the node at the index to a specific value.
+ * Frees the data of a batch which could not be added to the list.
  *
  * @param dll_t *list: pointer to the doubly linked list
- * @param unsigned long index: index
- * @param void *data: data pointer
- * @return dll_node_t*: pointer to the pushed node
-za */
-dll_node_t* dll_set(dll_t *list, unsigned long index, void *data)
+ * @param void **items: data pointers of the batch
+ * @param long batch: number of data pointers
+ * @return void
+ */
+void dll_freeBatch(dll_t *list, void **items, long batch)
 {
-    list->curr = dll_get(list, index);
-    list->curr->data = data;
+    long i;
 
-    return list->curr;
+    if (list->freeFn)
+        for (i = 0; i < batch; i++)
+            list->freeFn(items[i]);
 }
 
 /**
- * Pushs a new node to the head of the doubly linked list.
- * Sets the current node to the new node.
+ * Starts to load the elements of a file written by dll_save in the
+ * background, appending them to the list in batches like dll_load.
+ * Readers iterate the loaded elements with dll_streamIter and
+ * dll_streamNext while the rest is still loading. With a window the
+ * loader stays at most about window elements ahead of the slowest
+ * reader, which bounds the unread backlog. The elements every reader
+ * has passed stay in the list until dll_streamRelease frees them, so
+ * a consumer calling it now and then keeps the list at about window
+ * plus two batches of DLL_LOAD_BATCH elements.
+ * The list must not be used otherwise until dll_streamFinish returns.
  *
  * @param dll_t *list: pointer to the doubly linked list
- * @param void *data: data pointer
- * @return dll_node_t*: pointer to the pushed node
+ * @param const char *path: file name
+ * @param unsigned long window: maximum elements ahead of the readers, 0 for no limit
+ * @return dll_stream_t*: pointer of the stream, NULL on failure
  */
-dll_node_t* dll_pushHead(dll_t *list, void *data)
+dll_stream_t* dll_streamLoad(dll_t *list, const char *path, unsigned long window)
 {
     assert(list);
-    assert(data);
+    assert(list->deserializeFn);
+    assert(path);
 
-    if (list->head)
+    dll_stream_t *stream = calloc(1, sizeof(dll_stream_t));
+
+    if (stream)
     {
-        dll_node_t *new = dll_createNode(data);
+        stream->size = 256;
+        stream->items = malloc(DLL_LOAD_BATCH * sizeof(void*));
+        stream->buffer = malloc(stream->size);
+    }
 
-        if (new)
-        {
-            dll_node_t *tmp = list->head;
-            new->next = tmp;
-            list->head = tmp->prev = new;
-            list->size++;
-        }
+    if (!stream || !stream->items || !stream->buffer)
+    {
+        puts("ERROR: Out of memory");
+    }
+    else if ((stream->fp = dll_openFile(path, &stream->left)))
+    {
+        stream->list = list;
+        stream->window = window;
+        stream->last = list->tail;
+        stream->count = list->size;
+        stream->ok = 1;
+        pthread_mutex_init(&stream->lock, NULL);
+        pthread_cond_init(&stream->loaded, NULL);
+        pthread_cond_init(&stream->space, NULL);
 
-        return list->curr = new;
+        if (!pthread_create(&stream->thread, NULL, dll_streamLoader, stream))
+            return stream;
+
+        puts("ERROR: Cannot start the loader");
+        pthread_mutex_destroy(&stream->lock);
+        pthread_cond_destroy(&stream->loaded);
+        pthread_cond_destroy(&stream->space);
+        fclose(stream->fp);
     }
-    else
+
+    if (stream)
     {
-        return dll_addFirstNode(list, data);
+        free(stream->items);
+        free(stream->buffer);
+        free(stream);
     }
+
+    return NULL;
 }
 
 /**
- * Pushs a new node to the tail of the doubly linked list.
- * Sets the current node to the new node.
+ * Sets the iterator before the head of a streamed list and registers
+ * it as a reader, the nodes released so far are skipped. The reader
+ * holds back the loader and dll_streamRelease until dll_streamNext
+ * returned NULL or the iterator is closed with dll_streamIterClose.
  *
- * @param dll_t *list: pointer to the doubly linked list
- * @param void *data: data pointer
- * @return dll_node_t*: pointer to the pushed node
+ * @param dll_streamIter_t *it: pointer to the iterator
+ * @param dll_stream_t *stream: pointer to the stream
+ * @return void
  */
-dll_node_t* dll_pushTail(dll_t *list, void *data)
+void dll_streamIter(dll_streamIter_t *it, dll_stream_t *stream)
 {
-    assert(list);
-    assert(data);
+    assert(it);
+    assert(stream);
 
-    if (list->tail)
-    {
-        dll_node_t *new = dll_createNode(data);
+    pthread_mutex_lock(&stream->lock);
 
-        if (new)
-        {
-            dll_node_t *tmp = list->tail;
-            new->prev = tmp;
-            list->tail = tmp->next = new;
-            list->size++;
-        }
+    it->stream = stream;
+    it->node = it->limit = NULL;
+    it->pos = it->reported = stream->released;
+    it->nextReader = stream->readers;
+    stream->readers = it;
+    dll_streamConsumed(stream);
 
-        return list->curr = new;
-    }
-    else
-    {
-        return dll_addFirstNode(list, data);
-    }
+    pthread_mutex_unlock(&stream->lock);
 }
 
 /**
- * Adds a new node before a specific node.
- * Sets the current node to the new node.
+ * Moves the iterator to the next node of a streamed list, waiting for
+ * the loader if it is not loaded yet. The position is reported to the
+ * loader every DLL_LOAD_BATCH nodes and whenever the iterator waits.
+ * At the end the iterator stops being a reader of the stream.
  *
- * @param dll_t *list: pointer to the doubly linked list
- * @param dll_node_t *node: node to add before
- * @param void *data: data pointer
- * @return dll_node_t*: pointer to the added node
+ * @param dll_streamIter_t *it: pointer to the iterator
+ * @return dll_node_t*: the next node, NULL when all elements are read
  */
-dll_node_t* dll_addBefore(dll_t *list, dll_node_t *node, void *data)
+dll_node_t* dll_streamNext(dll_streamIter_t *it)
 {
-    assert(list);
-    assert(node);
-    assert(data);
+    assert(it);
 
-    dll_node_t *new = NULL;
+    dll_stream_t *stream = it->stream;
 
-    if (list->size)
+    if (it->node == it->limit || it->pos % DLL_LOAD_BATCH == 0)
     {
-        new = dll_createNode(data);
+        pthread_mutex_lock(&stream->lock);
 
-        if (new)
+        if (it->pos > it->reported)
         {
-            new->next = node;
-            new->prev = node->prev;
-            if (node == list->head)
-                list->head = new;
-            node->prev = new;
-            if (new->prev)
-                new->prev->next = new;
-            list->size++;
+            it->reported = it->pos;
+            dll_streamConsumed(stream);
         }
+
+        while (it->node == stream->last && !stream->done)
+            pthread_cond_wait(&stream->loaded, &stream->lock);
+
+        it->limit = stream->last;
+
+        if (it->node == it->limit)
+            dll_streamDetach(it);
+
+        pthread_mutex_unlock(&stream->lock);
+
+        if (it->node == it->limit)
+            return NULL;
     }
 
-    return list->curr = new;
+    it->node = it->node ? it->node->next : stream->list->head;
+    it->pos++;
+
+    return it->node;
 }
 
 /**
- * Adds a new node after a specific node.
- * Sets the current node to the new node.
+ * Stops a reader before the end of the stream, so it does not hold back
+ * the loader and dll_streamRelease anymore. Closing an iterator which
+ * already reached the end does nothing.
  *
- * @param dll_t *list: pointer to the doubly linked list
- * @param dll_node_t *node: node to add after
- * @param void *data: data pointer
- * @return dll_node_t*: pointer to the added node
+ * @param dll_streamIter_t *it: pointer to the iterator
+ * @return void
  */
-dll_node_t* dll_addAfter(dll_t *list, dll_node_t *node, void *data)
+void dll_streamIterClose(dll_streamIter_t *it)
 {
-    assert(list);
-    assert(node);
-    assert(data);
+    assert(it);
 
-    dll_node_t *new = NULL;
+    dll_stream_t *stream = it->stream;
 
-    if (list->size)
-    {
-        new = dll_createNode(data);
+    pthread_mutex_lock(&stream->lock);
+    dll_streamDetach(it);
+    pthread_mutex_unlock(&stream->lock);
+}
 
-        if (new)
-        {
-            new->prev = node;
-            new->next = node->next;
-            if (node == list->tail)
-                list->tail = new;
-            node->next = new;
-            if (new->next)
-                new->next->prev = new;
-            list->size++;
-        }
+/**
+ * Frees the nodes at the head of a streamed list which every reader has
+ * passed. The node a reader is at and the last loaded node are kept.
+ * Without readers nothing is freed. Can be called by any reader while
+ * the rest is still loading.
+ *
+ * @param dll_stream_t *stream: pointer to the stream
+ * @return unsigned long: number of nodes left in the list
+ */
+unsigned long dll_streamRelease(dll_stream_t *stream)
+{
+    assert(stream);
+
+    unsigned long size;
+
+    pthread_mutex_lock(&stream->lock);
+
+    while (stream->released + 1 < stream->consumed)
+    {
+        dll_popHead(stream->list);
+        stream->released++;
     }
 
-    return list->curr = new;
+    size = stream->list->size;
+
+    pthread_mutex_unlock(&stream->lock);
+
+    return size;
 }
 
 /**
- * Frees data and the node from memory.
+ * Waits until the whole file is loaded, the window does not hold back
+ * the loader anymore, and frees the stream. Afterwards the list can be
+ * used as usual. On failure the elements loaded so far stay in the list.
+ * All readers have to be at the end or closed before.
  *
- * @param dll_node_t *node: node to free
- * @return void
+ * @param dll_stream_t *stream: pointer to the stream
+ * @return int: success
  */
-void dll_freeNode(dll_t *list, dll_node_t *del)
+short int dll_streamFinish(dll_stream_t *stream)
 {
-    assert(list);
-    assert(list->freeFn);
+    assert(stream);
 
-    if (del && list->size)
+    short int ok;
+
+    pthread_mutex_lock(&stream->lock);
+    stream->finishing = 1;
+    pthread_cond_signal(&stream->space);
+    pthread_mutex_unlock(&stream->lock);
+
+    pthread_join(stream->thread, NULL);
+
+    ok = stream->ok;
+
+    pthread_mutex_destroy(&stream->lock);
+    pthread_cond_destroy(&stream->loaded);
+    pthread_cond_destroy(&stream->space);
+    fclose(stream->fp);
+    free(stream->items);
+    free(stream->buffer);
+    free(stream);
+
+    return ok;
+}
+
+/**
+ * Loader thread: reads the file batch by batch, appends the batches
+ * to the list and publishes them to the readers. The batches are
+ * appended with the lock held, as dll_streamRelease pops the head.
+ *
+ * @param void *arg: the stream
+ * @return void*: NULL
+ */
+void* dll_streamLoader(void *arg)
+{
+    dll_stream_t *stream = arg;
+    long batch;
+
+    for (;;)
     {
-        if (list->head == list->tail)
-            list->head = list->tail = NULL;
-        else if (del == list->head)
+        pthread_mutex_lock(&stream->lock);
+
+        while (stream->window && !stream->finishing
+               && stream->count - stream->consumed >= stream->window)
+            pthread_cond_wait(&stream->space, &stream->lock);
+
+        pthread_mutex_unlock(&stream->lock);
+
+        batch = dll_readBatch(stream->list, stream->fp, &stream->left,
+                              stream->items, &stream->buffer, &stream->size);
+
+        pthread_mutex_lock(&stream->lock);
+
+        if (batch > 0 && !dll_pushTailBulk(stream->list, stream->items, batch))
         {
-            list->head = del->next;
-            list->head->prev = NULL;
+            dll_freeBatch(stream->list, stream->items, batch);
+            batch = -1;
         }
-        else if (del == list->tail)
+
+        if (batch > 0)
         {
-            list->tail = del->prev;
-            list->tail->next = NULL;
+            stream->last = stream->list->tail;
+            stream->count += batch;
         }
         else
         {
-            del->prev->next = del->next;
-            del->next->prev = del->prev;
+            stream->ok = !batch;
+            stream->done = 1;
         }
 
-        if (del == list->curr)
-            list->curr = NULL;
-
-        list->freeFn(del->data);
-        del->prev = del->next = del->data = NULL;
-        free(del);
+        pthread_cond_broadcast(&stream->loaded);
+        pthread_mutex_unlock(&stream->lock);
 
-        list->size--;
+        if (batch <= 0)
+            break;
     }
+
+    if (!stream->ok)
+        puts("ERROR: Cannot load the stream");
+
+    return NULL;
 }
 
 /**
- * Deletes the node at the specific index.
+ * Initializes an iterator at the head of the list.
+ * Iterators keep their own position, the current node of the list is
+ * neither used nor changed, so any number of readers can iterate at once.
  *
+ * @param dll_iter_t *it: pointer to the iterator
  * @param dll_t *list: pointer to the doubly linked list
- * @param unsigned long index: index
  * @return void
  */
-void dll_delete(dll_t *list, unsigned long index)
+void dll_iterHead(dll_iter_t *it, dll_t *list)
 {
-    dll_freeNode(list, dll_get(list, index));
+    assert(it);
+    assert(list);
+
+    it->list = list;
+    it->node = list->head;
 }
 
 /**
- * Deletes the first node with the specific data from the list.
+ * Initializes an iterator at the tail of the list.
  *
+ * @param dll_iter_t *it: pointer to the iterator
  * @param dll_t *list: pointer to the doubly linked list
- * @param void *data: data pointer
- * @param int mode: search mode
  * @return void
  */
-void dll_searchAndDelete(dll_t *list, void *data, short int mode)
+void dll_iterTail(dll_iter_t *it, dll_t *list)
 {
+    assert(it);
     assert(list);
-    assert(data);
 
-    dll_node_t *found = dll_search(list, data, mode);
-
-    if (found)
-    {
-        dll_freeNode(list, found);
-    }
+    it->list = list;
+    it->node = list->tail;
 }
 
 /**
- * Deletes the first node of the doubly linked list.
+ * Initializes an iterator at the index.
  *
+ * @param dll_iter_t *it: pointer to the iterator
  * @param dll_t *list: pointer to the doubly linked list
+ * @param unsigned long index: index
  * @return void
  */
-void dll_popHead(dll_t *list)
+void dll_iterAt(dll_iter_t *it, dll_t *list, unsigned long index)
 {
-    assert(list);
+    assert(it);
 
-    dll_freeNode(list, list->head);
+    it->list = list;
+    it->node = dll_locate(list, index);
 }
 
 /**
- * Deletes the last node of the doubly linked list.
+ * Checks if the iterator points to a node.
  *
- * @param dll_t *list: pointer to the doubly linked list
- * @return void
+ * @param dll_iter_t *it: pointer to the iterator
+ * @return int: is valid
  */
-void dll_popTail(dll_t *list)
+short int dll_iterValid(dll_iter_t *it)
 {
-    assert(list);
+    assert(it);
 
-    dll_freeNode(list, list->tail);
+    return it->node != NULL;
 }
 
 /**
- * Destroys the whole list and frees it from memory.
+ * Returns the node of the iterator.
  *
- * @param dll_t *list: pointer to the doubly linked list
- * @return void
+ * @param dll_iter_t *it: pointer to the iterator
+ * @return dll_node_t*: node, NULL past the ends
  */
-void dll_clear(dll_t *list)
+dll_node_t* dll_iterNode(dll_iter_t *it)
 {
-    if (list)
-    {
-        dll_node_t *n = list->head;
+    assert(it);
 
-        while (n)
-        {
-            dll_node_t *del = n;
-            n = n->next;
-            dll_freeNode(list, del);
-        }
-        free(list);
-    }
+    return it->node;
 }
 
 /**
- * Reverses the list.
+ * Steps the iterator to the next node.
+ * Past the tail it stays at NULL.
  *
- * @param dll_t *list: pointer to the doubly linked list
- * @return void
+ * @param dll_iter_t *it: pointer to the iterator
+ * @return dll_node_t*: next node
  */
-void dll_reverse(dll_t *list)
+dll_node_t* dll_iterNext(dll_iter_t *it)
 {
-    assert(list);
+    assert(it);
 
-    dll_node_t *i = list->head, *j = list->tail;
-
-    while (i != j && i != j->next)
-    {
-        void *data = i->data;
-        i->data = j->data;
-        j->data = data;
+    if (it->node)
+        it->node = it->node->next;
 
-        i = i->next;
-        j = j->prev;
-    }
+    return it->node;
 }
 
 /**
- * Sorts the list with the insertion sort algorithm.
+ * Steps the iterator to the previous node.
+ * Before the head it stays at NULL.
  *
- * The order of the nodes is defined through the compareFn function.
+ * @param dll_iter_t *it: pointer to the iterator
+ * @return dll_node_t*: previous node
+ */
+dll_node_t* dll_iterPrev(dll_iter_t *it)
+{
+    assert(it);
+
+    if (it->node)
+        it->node = it->node->prev;
+
+    return it->node;
+}
+
+/**
+ * Adds a new node before the node of the iterator,
+ * past the tail the node is pushed to the tail.
+ * The iterator keeps its position.
  *
- * @param dll_t *list: pointer to the doubly linked list
- * @return void
+ * @param dll_iter_t *it: pointer to the iterator
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the added node
  */
-void dll_sort(dll_t *list)
+dll_node_t* dll_iterInsertBefore(dll_iter_t *it, void *data)
 {
-    assert(list);
-    assert(list->compareFn);
+    assert(it);
+    assert(data);
 
-    dll_node_t *i = list->head, *j, *tmp;
-    while (i)
-    {
-        tmp = j = i;
+    return dll_insert(it->list, it->node ? it->node->prev : it->list->tail, data);
+}
 
-        while (j)
-        {
-            if (list->compareFn(tmp->data, j->data) == 1)
-                tmp = j;
-            j = j->next;
-        }
-        void *data = tmp->data;
-        tmp->data = i->data;
-        i->data = data;
+/**
+ * Adds a new node after the node of the iterator.
+ * The iterator keeps its position.
+ *
+ * @param dll_iter_t *it: pointer to the iterator
+ * @param void *data: data pointer
+ * @return dll_node_t*: pointer to the added node
+ */
+dll_node_t* dll_iterInsertAfter(dll_iter_t *it, void *data)
+{
+    assert(it);
+    assert(it->node);
+    assert(data);
 
-        i = i->next;
-    }
+    return dll_insert(it->list, it->node, data);
 }
 
 /**
- * Prints the list.
+ * Deletes the node of the iterator and steps to the next node.
  *
- * @param dll_t *list: pointer to the doubly linked list
+ * @param dll_iter_t *it: pointer to the iterator
  * @return void
  */
-void dll_print(dll_t *list)
+void dll_iterErase(dll_iter_t *it)
 {
-    assert(list);
-    assert(list->printFn);
-
-    printf("--- head ---\n");
+    assert(it);
 
-    dll_traverse(list, list->printFn);
+    dll_node_t *del = it->node;
 
-    printf("--- tail ---\n");
+    if (del)
+    {
+        it->node = del->next;
+        dll_freeNode(it->list, del);
+    }
 }
@@ -24,13 +24,58 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* uncomment to count the operations of every list (see dll_stats) */
+// #define DLL_STATS
+
 typedef struct Node
 {
 	void *data;
 	struct Node *prev;
 	struct Node *next;
+	struct doublyLinkedList *owner;
+	struct dll_skip *skip;
 } dll_node_t;
 
+struct dll_pool;
+struct dll_hash;
+struct dll_skip;
+struct dll_stream;
+struct dll_compact;
+
+/**
+ * Operation counters and latency histograms of a list, see dll_stats.
+ * The histograms have DLL_STATS_SUB buckets per power of two of the
+ * latency in ns (HDR style), latencies below 2 * DLL_STATS_SUB ns have
+ * one bucket per ns.
+ */
+#define DLL_STATS_SUB 8
+#define DLL_STATS_BUCKETS (2 * DLL_STATS_SUB + 36 * DLL_STATS_SUB)
+
+typedef enum
+{
+	DLL_OP_INSERT,
+	DLL_OP_DELETE,
+	DLL_OP_GET,
+	DLL_OP_SEARCH,
+	DLL_OP_SORT,
+	DLL_OP_REVERSE,
+	DLL_OP_SPLICE,
+	DLL_OP_TRAVERSE,
+	DLL_OP_COUNT
+} dll_op_t;
+
+typedef struct
+{
+	unsigned long long ops[DLL_OP_COUNT];
+	unsigned long long compares;
+	unsigned long long getVisits;
+	unsigned long long searchVisits;
+	unsigned long long allocs;
+	unsigned long long frees;
+	unsigned long long getLatency[DLL_STATS_BUCKETS];
+	unsigned long long searchLatency[DLL_STATS_BUCKETS];
+} dll_stats_t;
+
 typedef struct doublyLinkedList
 {
 	dll_node_t *head;
@@ -40,12 +85,59 @@ typedef struct doublyLinkedList
 	int (*compareFn)(void*, void*);
 	void (*freeFn)(void*);
 	void (*printFn)(void*);
+	unsigned long (*hashFn)(void*);
+	unsigned long (*serializeFn)(void*, void*, unsigned long);
+	void* (*deserializeFn)(void*, unsigned long);
+	struct dll_pool *pool;
+	struct dll_hash *hash;
+	struct dll_skip *index;
+	struct dll_compact *compact;
+	unsigned long long seed;
+	short int sorted;
+#ifdef DLL_STATS
+	dll_stats_t stats;
+#endif
 } dll_t;
 
+typedef struct
+{
+	dll_t *list;
+	dll_node_t *node;
+} dll_iter_t;
+
+typedef struct dll_stream dll_stream_t;
+
+typedef struct dll_streamIter
+{
+	dll_stream_t *stream;
+	dll_node_t *node;
+	dll_node_t *limit;
+	unsigned long pos;
+	unsigned long reported;
+	struct dll_streamIter *nextReader;
+} dll_streamIter_t;
+
+typedef enum
+{
+	DLL_KEY_I32,
+	DLL_KEY_U32,
+	DLL_KEY_I64,
+	DLL_KEY_U64
+} dll_keyType_t;
+
 dll_t* dll_create();
+dll_t* dll_createWithPool(unsigned long chunkNodes);
+dll_t* dll_createSharingPool(dll_t *list);
 void dll_registerCompareFn(dll_t *list, int (*compareFn)(void*, void*) );
 void dll_registerFreeFn(dll_t *list, void (*freeFn)(void*) );
 void dll_registerPrintFn(dll_t *list, void (*printFn)(void*) );
+void dll_registerSerializeFn(dll_t *list, unsigned long (*serializeFn)(void*, void*, unsigned long) );
+void dll_registerDeserializeFn(dll_t *list, void* (*deserializeFn)(void*, unsigned long) );
+short int dll_registerHashFn(dll_t *list, unsigned long (*hashFn)(void*) );
+short int dll_enableIndex(dll_t *list);
+void dll_disableIndex(dll_t *list);
+short int dll_enableSorted(dll_t *list);
+void dll_disableSorted(dll_t *list);
 dll_node_t* dll_head(dll_t *list);
 dll_node_t* dll_tail(dll_t *list);
 dll_node_t* dll_curr(dll_t *list);
@@ -55,22 +147,63 @@ dll_node_t* dll_next(dll_t *list);
 short int dll_hasPrev(dll_t *list);
 dll_node_t* dll_prev(dll_t *list);
 void dll_traverse(dll_t *list, void (*callback)(void*) );
+void dll_parallelTraverse(dll_t *list, void (*callback)(void*), unsigned int threads);
+dll_t* dll_map(dll_t *list, void* (*mapFn)(void*), unsigned int threads);
+void* dll_reduce(dll_t *list, void* (*reduceFn)(void*, void*), void* (*combineFn)(void*, void*), unsigned int threads);
 short int dll_contains(dll_t *list, dll_node_t *node);
 dll_node_t* dll_get(dll_t *list, unsigned long index);
+unsigned long dll_indexOf(dll_t *list, dll_node_t *node);
 dll_node_t* dll_searchHeadToTail(dll_t *list, void *data);
 dll_node_t* dll_searchTailToHead(dll_t *list, void *data);
 dll_node_t* dll_searchHeadAndTail(dll_t *list, void *data);
+dll_node_t* dll_searchHash(dll_t *list, void *data);
 dll_node_t* dll_search(dll_t *list, void *data, short int mode);
 dll_node_t* dll_set(dll_t *list, unsigned long index, void *data);
 dll_node_t* dll_pushHead(dll_t *list, void *data);
 dll_node_t* dll_pushTail(dll_t *list, void *data);
+short int dll_pushHeadBulk(dll_t *list, void **items, unsigned long n);
+short int dll_pushTailBulk(dll_t *list, void **items, unsigned long n);
 dll_node_t* dll_addBefore(dll_t *list, dll_node_t *node, void *data);
 dll_node_t* dll_addAfter(dll_t *list, dll_node_t *node, void *data);
+dll_node_t* dll_insertSorted(dll_t *list, void *data);
 void dll_delete(dll_t *list, unsigned long index);
 void dll_searchAndDelete(dll_t *list, void *data, short int mode);
 void dll_popHead(dll_t *list);
 void dll_popTail(dll_t *list);
 void dll_clear(dll_t *list);
+void dll_clearDeferred(dll_t *list);
+void dll_reclaimWait(void);
+short int dll_compact(dll_t *list);
+unsigned long dll_compactStep(dll_t *list, unsigned long nodes);
+short int dll_splice(dll_t *dst, dll_node_t *pos, dll_t *src, dll_node_t *first, dll_node_t *last);
+short int dll_concat(dll_t *dst, dll_t *src);
+dll_t* dll_splitAt(dll_t *list, unsigned long index);
 void dll_reverse(dll_t *list);
 void dll_sort(dll_t *list);
+void dll_sortParallel(dll_t *list, unsigned int threads);
+short int dll_sortByKey(dll_t *list, unsigned long long (*keyFn)(void*) );
+short int dll_sortByIntKey(dll_t *list, unsigned long offset, dll_keyType_t type);
+dll_t* dll_topK(dll_t *list, unsigned long k);
+dll_node_t* dll_nthElement(dll_t *list, unsigned long index);
 void dll_print(dll_t *list);
+short int dll_stats(dll_t *list, dll_stats_t *stats);
+void dll_statsReset(dll_t *list);
+unsigned long long dll_statsPercentile(unsigned long long *histogram, double percent);
+short int dll_save(dll_t *list, const char *path);
+short int dll_load(dll_t *list, const char *path);
+dll_stream_t* dll_streamLoad(dll_t *list, const char *path, unsigned long window);
+void dll_streamIter(dll_streamIter_t *it, dll_stream_t *stream);
+dll_node_t* dll_streamNext(dll_streamIter_t *it);
+void dll_streamIterClose(dll_streamIter_t *it);
+unsigned long dll_streamRelease(dll_stream_t *stream);
+short int dll_streamFinish(dll_stream_t *stream);
+void dll_iterHead(dll_iter_t *it, dll_t *list);
+void dll_iterTail(dll_iter_t *it, dll_t *list);
+void dll_iterAt(dll_iter_t *it, dll_t *list, unsigned long index);
+short int dll_iterValid(dll_iter_t *it);
+dll_node_t* dll_iterNode(dll_iter_t *it);
+dll_node_t* dll_iterNext(dll_iter_t *it);
+dll_node_t* dll_iterPrev(dll_iter_t *it);
+dll_node_t* dll_iterInsertBefore(dll_iter_t *it, void *data);
+dll_node_t* dll_iterInsertAfter(dll_iter_t *it, void *data);
+void dll_iterErase(dll_iter_t *it);
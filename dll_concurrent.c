@@ -0,0 +1,383 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ *  @file   dll_concurrent.c
+ *  @author Marc Zimmermann (tooreht@gmail.com)
+ *  @date   December, 2012
+ *  @brief  Implementation of a thread-safe doubly linked list.
+ *
+ *  Function implementations of the concurrent doublyLinkedList.
+ *
+ *  The nodes lie between the head and the tail sentinel. An operation on
+ *  the head only touches the head sentinel and the first two nodes, an
+ *  operation on the tail only the last two nodes and the tail sentinel.
+ *  As long as enough nodes lie in between, both sides run in parallel
+ *  under their own lock. A pop reserves its node by decrementing the size
+ *  before unlinking it, a push counts its node after linking it, thus the
+ *  size never exceeds the number of linked nodes. Below DLLC_MARGIN nodes
+ *  an operation takes both locks (head before tail).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+/* uncomment to ignore the assertions (no debug) */
+// #define NDEBUG
+#include <assert.h>
+
+#include "dll_concurrent.h"
+
+#define DLLC_MARGIN 4
+
+/**
+ * static function definitions
+ */
+static void dllc_lockBoth(dllc_t *list);
+static void dllc_unlockBoth(dllc_t *list);
+static void dllc_link(dllc_node_t *prev, dllc_node_t *new, dllc_node_t *next);
+static dllc_node_t* dllc_unlink(dllc_node_t *del);
+
+/**
+ * Creates a new concurrent doubly linked list.
+ *
+ * @param void
+ * @return dllc_t*: pointer of new concurrent doubly linked list
+ */
+dllc_t* dllc_create(void)
+{
+    dllc_t *new = malloc(sizeof(dllc_t));
+
+    if (new)
+    {
+        new->head.data = new->tail.data = NULL;
+        new->head.prev = new->tail.next = NULL;
+        new->head.next = &new->tail;
+        new->tail.prev = &new->head;
+        atomic_init(&new->size, 0);
+        pthread_mutex_init(&new->headLock, NULL);
+        pthread_mutex_init(&new->tailLock, NULL);
+        new->freeFn = NULL;
+    }
+    else
+    {
+        puts("ERROR: Out of memory");
+    }
+
+    return new;
+}
+
+/**
+ * Registers freeFn callback function on the list.
+ * It is only used by dllc_clear, popped data is returned to the caller.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @param void (*freeFn)(void*): callback function freeFn
+ * @return void
+ */
+void dllc_registerFreeFn(dllc_t *list, void (*freeFn)(void*) )
+{
+    assert(list);
+    assert(freeFn);
+
+    list->freeFn = freeFn;
+}
+
+/**
+ * Returns the size of the list. Pops in progress are already subtracted.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @return unsigned long: size
+ */
+unsigned long dllc_size(dllc_t *list)
+{
+    assert(list);
+
+    return atomic_load(&list->size);
+}
+
+/**
+ * Takes the head and the tail lock.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @return void
+ */
+void dllc_lockBoth(dllc_t *list)
+{
+    pthread_mutex_lock(&list->headLock);
+    pthread_mutex_lock(&list->tailLock);
+}
+
+/**
+ * Releases the head and the tail lock.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @return void
+ */
+void dllc_unlockBoth(dllc_t *list)
+{
+    pthread_mutex_unlock(&list->tailLock);
+    pthread_mutex_unlock(&list->headLock);
+}
+
+/**
+ * Links a new node between two adjacent nodes.
+ *
+ * @param dllc_node_t *prev: previous node
+ * @param dllc_node_t *new: new node
+ * @param dllc_node_t *next: next node
+ * @return void
+ */
+void dllc_link(dllc_node_t *prev, dllc_node_t *new, dllc_node_t *next)
+{
+    new->prev = prev;
+    new->next = next;
+    next->prev = new;
+    prev->next = new;
+}
+
+/**
+ * Unlinks a node, it is freed by the caller after releasing the lock.
+ *
+ * @param dllc_node_t *del: node to unlink
+ * @return dllc_node_t*: unlinked node
+ */
+dllc_node_t* dllc_unlink(dllc_node_t *del)
+{
+    del->prev->next = del->next;
+    del->next->prev = del->prev;
+
+    return del;
+}
+
+/**
+ * Pushs data to the head of the list.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @param void *data: data pointer
+ * @return int: success
+ */
+short int dllc_pushHead(dllc_t *list, void *data)
+{
+    assert(list);
+    assert(data);
+
+    dllc_node_t *new = malloc(sizeof(dllc_node_t));
+
+    if (!new)
+    {
+        puts("ERROR: Out of memory");
+        return 0;
+    }
+
+    new->data = data;
+
+    pthread_mutex_lock(&list->headLock);
+
+    if (atomic_load(&list->size) >= DLLC_MARGIN)
+    {
+        dllc_link(&list->head, new, list->head.next);
+        atomic_fetch_add(&list->size, 1);
+        pthread_mutex_unlock(&list->headLock);
+    }
+    else
+    {
+        pthread_mutex_lock(&list->tailLock);
+        dllc_link(&list->head, new, list->head.next);
+        atomic_fetch_add(&list->size, 1);
+        dllc_unlockBoth(list);
+    }
+
+    return 1;
+}
+
+/**
+ * Pushs data to the tail of the list.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @param void *data: data pointer
+ * @return int: success
+ */
+short int dllc_pushTail(dllc_t *list, void *data)
+{
+    assert(list);
+    assert(data);
+
+    dllc_node_t *new = malloc(sizeof(dllc_node_t));
+
+    if (!new)
+    {
+        puts("ERROR: Out of memory");
+        return 0;
+    }
+
+    new->data = data;
+
+    pthread_mutex_lock(&list->tailLock);
+
+    if (atomic_load(&list->size) >= DLLC_MARGIN)
+    {
+        dllc_link(list->tail.prev, new, &list->tail);
+        atomic_fetch_add(&list->size, 1);
+        pthread_mutex_unlock(&list->tailLock);
+    }
+    else
+    {
+        /* the head lock has to be taken first */
+        pthread_mutex_unlock(&list->tailLock);
+        dllc_lockBoth(list);
+        dllc_link(list->tail.prev, new, &list->tail);
+        atomic_fetch_add(&list->size, 1);
+        dllc_unlockBoth(list);
+    }
+
+    return 1;
+}
+
+/**
+ * Pops the data of the head. The data is not freed.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @return void*: data pointer, NULL if the list is empty
+ */
+void* dllc_popHead(dllc_t *list)
+{
+    assert(list);
+
+    dllc_node_t *del = NULL;
+    void *data = NULL;
+    unsigned long size;
+
+    pthread_mutex_lock(&list->headLock);
+
+    size = atomic_load(&list->size);
+
+    while (size >= DLLC_MARGIN)
+    {
+        if (atomic_compare_exchange_weak(&list->size, &size, size - 1))
+        {
+            del = dllc_unlink(list->head.next);
+            break;
+        }
+    }
+
+    if (del)
+    {
+        pthread_mutex_unlock(&list->headLock);
+    }
+    else
+    {
+        pthread_mutex_lock(&list->tailLock);
+
+        if (atomic_load(&list->size))
+        {
+            atomic_fetch_sub(&list->size, 1);
+            del = dllc_unlink(list->head.next);
+        }
+
+        dllc_unlockBoth(list);
+    }
+
+    if (del)
+    {
+        data = del->data;
+        free(del);
+    }
+
+    return data;
+}
+
+/**
+ * Pops the data of the tail. The data is not freed.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @return void*: data pointer, NULL if the list is empty
+ */
+void* dllc_popTail(dllc_t *list)
+{
+    assert(list);
+
+    dllc_node_t *del = NULL;
+    void *data = NULL;
+    unsigned long size;
+
+    pthread_mutex_lock(&list->tailLock);
+
+    size = atomic_load(&list->size);
+
+    while (size >= DLLC_MARGIN)
+    {
+        if (atomic_compare_exchange_weak(&list->size, &size, size - 1))
+        {
+            del = dllc_unlink(list->tail.prev);
+            break;
+        }
+    }
+
+    if (del)
+    {
+        pthread_mutex_unlock(&list->tailLock);
+    }
+    else
+    {
+        pthread_mutex_unlock(&list->tailLock);
+        dllc_lockBoth(list);
+
+        if (atomic_load(&list->size))
+        {
+            atomic_fetch_sub(&list->size, 1);
+            del = dllc_unlink(list->tail.prev);
+        }
+
+        dllc_unlockBoth(list);
+    }
+
+    if (del)
+    {
+        data = del->data;
+        free(del);
+    }
+
+    return data;
+}
+
+/**
+ * Destroys the whole list and frees it from memory.
+ * No other thread may use the list anymore.
+ *
+ * @param dllc_t *list: pointer to the concurrent doubly linked list
+ * @return void
+ */
+void dllc_clear(dllc_t *list)
+{
+    if (list)
+    {
+        dllc_node_t *n = list->head.next;
+
+        while (n != &list->tail)
+        {
+            dllc_node_t *del = n;
+            n = n->next;
+            if (list->freeFn)
+                list->freeFn(del->data);
+            free(del);
+        }
+
+        pthread_mutex_destroy(&list->headLock);
+        pthread_mutex_destroy(&list->tailLock);
+        free(list);
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ * 	@file   dll_concurrent.h
+ * 	@author Marc Zimmermann (tooreht@gmail.com)
+ * 	@date   December, 2012
+ * 	@brief  Thread-safe doubly linked list, header file.
+ *
+ * 	Structure and function definitions of the concurrent doublyLinkedList.
+ * 	Operations on the head and on the tail take separate locks, so they
+ * 	proceed in parallel as long as the list is not nearly empty.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct ConcurrentNode
+{
+	void *data;
+	struct ConcurrentNode *prev;
+	struct ConcurrentNode *next;
+} dllc_node_t;
+
+typedef struct concurrentDoublyLinkedList
+{
+	dllc_node_t head;
+	dllc_node_t tail;
+	atomic_ulong size;
+	pthread_mutex_t headLock;
+	pthread_mutex_t tailLock;
+	void (*freeFn)(void*);
+} dllc_t;
+
+dllc_t* dllc_create(void);
+void dllc_registerFreeFn(dllc_t *list, void (*freeFn)(void*) );
+unsigned long dllc_size(dllc_t *list);
+short int dllc_pushHead(dllc_t *list, void *data);
+short int dllc_pushTail(dllc_t *list, void *data);
+void* dllc_popHead(dllc_t *list);
+void* dllc_popTail(dllc_t *list);
+void dllc_clear(dllc_t *list);
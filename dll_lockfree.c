@@ -0,0 +1,475 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ *  @file   dll_lockfree.c
+ *  @author Marc Zimmermann (tooreht@gmail.com)
+ *  @date   December, 2012
+ *  @brief  Implementation of a lock-free work queue.
+ *
+ *  Function implementations of the lock-free queue (Michael & Scott).
+ *
+ *  The head always points to a dummy node, the data is taken from its
+ *  successor, which then becomes the new dummy. Popped dummies are freed
+ *  with hazard pointers: before a thread dereferences a node it publishes
+ *  the pointer in its hazard record, and a retired node is only freed when
+ *  no record holds it. Every thread acquires a record on its first
+ *  operation and hands it back with dllf_threadExit.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+/* uncomment to ignore the assertions (no debug) */
+// #define NDEBUG
+#include <assert.h>
+
+#include "dll_lockfree.h"
+
+#define DLLF_HAZARDS 2
+#define DLLF_RETIRE_MIN 64
+
+/**
+ * Hazard record of a thread: the published hazard pointers and the
+ * nodes the thread retired but could not free yet.
+ */
+typedef struct dllf_hazard
+{
+    _Atomic(dllf_node_t*) hp[DLLF_HAZARDS];
+    atomic_int active;
+    struct dllf_hazard *next;
+    dllf_node_t **retired;
+    unsigned long count;
+    unsigned long capacity;
+} dllf_hazard_t;
+
+static _Atomic(dllf_hazard_t*) dllf_records;
+static atomic_ulong dllf_nrecords;
+static atomic_ulong dllf_generation;
+static _Thread_local dllf_hazard_t *dllf_self;
+static _Thread_local unsigned long dllf_selfGeneration;
+
+/**
+ * static function definitions
+ */
+static dllf_hazard_t* dllf_hazard(void);
+static dllf_node_t* dllf_protect(dllf_hazard_t *self, int i, _Atomic(dllf_node_t*) *src);
+static void dllf_retire(dllf_hazard_t *self, dllf_node_t *node);
+static void dllf_scan(dllf_hazard_t *self);
+static int dllf_comparePtr(const void *a, const void *b);
+
+/**
+ * Creates a new lock-free queue.
+ *
+ * @param void
+ * @return dllf_t*: pointer of new lock-free queue
+ */
+dllf_t* dllf_create(void)
+{
+    dllf_t *new = aligned_alloc(64, sizeof(dllf_t));
+    dllf_node_t *dummy = malloc(sizeof(dllf_node_t));
+
+    if (new && dummy)
+    {
+        dummy->data = NULL;
+        atomic_init(&dummy->next, NULL);
+        atomic_init(&new->head, dummy);
+        atomic_init(&new->tail, dummy);
+        new->freeFn = NULL;
+    }
+    else
+    {
+        puts("ERROR: Out of memory");
+        free(dummy);
+        free(new);
+        new = NULL;
+    }
+
+    return new;
+}
+
+/**
+ * Registers freeFn callback function on the queue.
+ * It is only used by dllf_clear, popped data is returned to the caller.
+ *
+ * @param dllf_t *queue: pointer to the lock-free queue
+ * @param void (*freeFn)(void*): callback function freeFn
+ * @return void
+ */
+void dllf_registerFreeFn(dllf_t *queue, void (*freeFn)(void*) )
+{
+    assert(queue);
+    assert(freeFn);
+
+    queue->freeFn = freeFn;
+}
+
+/**
+ * Returns the hazard record of the calling thread. An inactive record
+ * is reused, otherwise a new one is added to the global record list.
+ * A record the thread got before the last dllf_cleanup was freed by it
+ * and is replaced.
+ *
+ * @param void
+ * @return dllf_hazard_t*: hazard record, NULL if out of memory
+ */
+dllf_hazard_t* dllf_hazard(void)
+{
+    dllf_hazard_t *r;
+    int inactive;
+
+    if (dllf_self && dllf_selfGeneration == atomic_load(&dllf_generation))
+        return dllf_self;
+
+    dllf_self = NULL;
+    dllf_selfGeneration = atomic_load(&dllf_generation);
+
+    for (r = atomic_load(&dllf_records); r; r = r->next)
+    {
+        inactive = 0;
+        if (atomic_compare_exchange_strong(&r->active, &inactive, 1))
+            return dllf_self = r;
+    }
+
+    r = calloc(1, sizeof(dllf_hazard_t));
+
+    if (!r)
+    {
+        puts("ERROR: Out of memory");
+        return NULL;
+    }
+
+    atomic_init(&r->active, 1);
+    r->next = atomic_load(&dllf_records);
+
+    while (!atomic_compare_exchange_weak(&dllf_records, &r->next, r))
+        ;
+
+    atomic_fetch_add(&dllf_nrecords, 1);
+
+    return dllf_self = r;
+}
+
+/**
+ * Loads a pointer and publishes it as hazard pointer, until the
+ * published value is still the current one.
+ *
+ * @param dllf_hazard_t *self: hazard record of the thread
+ * @param int i: hazard pointer slot
+ * @param _Atomic(dllf_node_t*) *src: pointer to load
+ * @return dllf_node_t*: protected pointer
+ */
+dllf_node_t* dllf_protect(dllf_hazard_t *self, int i, _Atomic(dllf_node_t*) *src)
+{
+    dllf_node_t *p = atomic_load(src), *q;
+
+    while (1)
+    {
+        atomic_store(&self->hp[i], p);
+        q = atomic_load(src);
+        if (p == q)
+            return p;
+        p = q;
+    }
+}
+
+/**
+ * Compares two pointers for qsort and bsearch.
+ *
+ * @param const void *a: pointer to the first pointer
+ * @param const void *b: pointer to the second pointer
+ * @return int: order
+ */
+int dllf_comparePtr(const void *a, const void *b)
+{
+    const void *x = *(void * const *) a, *y = *(void * const *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Frees every retired node of the thread, which is not hazardous.
+ *
+ * @param dllf_hazard_t *self: hazard record of the thread
+ * @return void
+ */
+void dllf_scan(dllf_hazard_t *self)
+{
+    /* records are only ever added in front, so the list from first is fixed */
+    dllf_hazard_t *first = atomic_load(&dllf_records), *r;
+    unsigned long n = 0, h = 0, i, kept = 0;
+    dllf_node_t **hazards;
+    int j;
+
+    for (r = first; r; r = r->next)
+        n += DLLF_HAZARDS;
+
+    hazards = malloc(n * sizeof(dllf_node_t*));
+
+    if (!hazards)
+        return;
+
+    for (r = first; r; r = r->next)
+    {
+        for (j = 0; j < DLLF_HAZARDS; j++)
+        {
+            dllf_node_t *p = atomic_load(&r->hp[j]);
+            if (p)
+                hazards[h++] = p;
+        }
+    }
+
+    qsort(hazards, h, sizeof(dllf_node_t*), dllf_comparePtr);
+
+    for (i = 0; i < self->count; i++)
+    {
+        if (bsearch(&self->retired[i], hazards, h, sizeof(dllf_node_t*), dllf_comparePtr))
+            self->retired[kept++] = self->retired[i];
+        else
+            free(self->retired[i]);
+    }
+
+    self->count = kept;
+    free(hazards);
+}
+
+/**
+ * Retires a node, which is freed as soon as no thread holds it.
+ * If the retired nodes cannot be grown, they are scanned to make room,
+ * and if that does not help the node is never freed.
+ *
+ * @param dllf_hazard_t *self: hazard record of the thread
+ * @param dllf_node_t *node: unlinked node
+ * @return void
+ */
+void dllf_retire(dllf_hazard_t *self, dllf_node_t *node)
+{
+    if (self->count == self->capacity)
+    {
+        unsigned long capacity = self->capacity ? self->capacity * 2 : DLLF_RETIRE_MIN;
+        dllf_node_t **retired = realloc(self->retired, capacity * sizeof(dllf_node_t*));
+
+        if (retired)
+        {
+            self->retired = retired;
+            self->capacity = capacity;
+        }
+        else
+        {
+            dllf_scan(self);
+        }
+    }
+
+    if (self->count == self->capacity)
+    {
+        puts("ERROR: Out of memory");
+        return;
+    }
+
+    self->retired[self->count++] = node;
+
+    if (self->count >= DLLF_RETIRE_MIN
+        && self->count >= 2 * DLLF_HAZARDS * atomic_load(&dllf_nrecords))
+        dllf_scan(self);
+}
+
+/**
+ * Pushs data to the tail of the queue.
+ *
+ * @param dllf_t *queue: pointer to the lock-free queue
+ * @param void *data: data pointer
+ * @return int: success
+ */
+short int dllf_pushTail(dllf_t *queue, void *data)
+{
+    assert(queue);
+    assert(data);
+
+    dllf_hazard_t *self = dllf_hazard();
+    dllf_node_t *new, *tail, *next;
+
+    if (!self)
+        return 0;
+
+    new = malloc(sizeof(dllf_node_t));
+
+    if (!new)
+    {
+        puts("ERROR: Out of memory");
+        return 0;
+    }
+
+    new->data = data;
+    atomic_init(&new->next, NULL);
+
+    while (1)
+    {
+        tail = dllf_protect(self, 0, &queue->tail);
+        next = atomic_load(&tail->next);
+
+        if (tail != atomic_load(&queue->tail))
+            continue;
+
+        if (next)
+        {
+            /* help a push, which linked its node but did not swing the tail */
+            atomic_compare_exchange_weak(&queue->tail, &tail, next);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak(&tail->next, &next, new))
+            break;
+    }
+
+    atomic_compare_exchange_strong(&queue->tail, &tail, new);
+    atomic_store(&self->hp[0], NULL);
+
+    return 1;
+}
+
+/**
+ * Pops the data of the head. The data is not freed.
+ *
+ * @param dllf_t *queue: pointer to the lock-free queue
+ * @return void*: data pointer, NULL if the queue is empty or out of memory
+ */
+void* dllf_popHead(dllf_t *queue)
+{
+    assert(queue);
+
+    dllf_hazard_t *self = dllf_hazard();
+    dllf_node_t *head, *tail, *next;
+    void *data;
+
+    if (!self)
+        return NULL;
+
+    while (1)
+    {
+        data = NULL;
+        head = dllf_protect(self, 0, &queue->head);
+        tail = atomic_load(&queue->tail);
+        next = dllf_protect(self, 1, &head->next);
+
+        if (head != atomic_load(&queue->head))
+            continue;
+
+        if (!next)
+            break;
+
+        if (head == tail)
+        {
+            atomic_compare_exchange_weak(&queue->tail, &tail, next);
+            continue;
+        }
+
+        data = next->data;
+
+        if (atomic_compare_exchange_weak(&queue->head, &head, next))
+            break;
+    }
+
+    atomic_store(&self->hp[0], NULL);
+    atomic_store(&self->hp[1], NULL);
+
+    if (data)
+        dllf_retire(self, head);
+
+    return data;
+}
+
+/**
+ * Hands the hazard record of the calling thread back. Nodes which are
+ * still hazardous stay retired in the record for its next owner.
+ * Should be called by every thread using a queue before it exits.
+ *
+ * @param void
+ * @return void
+ */
+void dllf_threadExit(void)
+{
+    if (dllf_self && dllf_selfGeneration != atomic_load(&dllf_generation))
+        dllf_self = NULL;
+
+    if (dllf_self)
+    {
+        dllf_scan(dllf_self);
+        atomic_store(&dllf_self->active, 0);
+        dllf_self = NULL;
+    }
+}
+
+/**
+ * Destroys the whole queue and frees it from memory.
+ * No other thread may use the queue anymore.
+ *
+ * @param dllf_t *queue: pointer to the lock-free queue
+ * @return void
+ */
+void dllf_clear(dllf_t *queue)
+{
+    if (queue)
+    {
+        dllf_node_t *n = atomic_load(&queue->head), *del;
+
+        /* the first node is the dummy, its data was already popped */
+        del = n;
+        n = atomic_load(&n->next);
+        free(del);
+
+        while (n)
+        {
+            if (queue->freeFn)
+                queue->freeFn(n->data);
+            del = n;
+            n = atomic_load(&n->next);
+            free(del);
+        }
+
+        free(queue);
+    }
+}
+
+/**
+ * Frees all hazard records and the nodes still retired in them, which
+ * otherwise live until the process exits. No thread may use any queue
+ * during the call. Afterwards every thread can start over with new
+ * queues: the generation is advanced, so threads which held a record
+ * get a new one on their next operation.
+ *
+ * @param void
+ * @return void
+ */
+void dllf_cleanup(void)
+{
+    dllf_hazard_t *r = atomic_exchange(&dllf_records, NULL), *del;
+    unsigned long i;
+
+    while (r)
+    {
+        for (i = 0; i < r->count; i++)
+            free(r->retired[i]);
+
+        del = r;
+        r = r->next;
+        free(del->retired);
+        free(del);
+    }
+
+    atomic_store(&dllf_nrecords, 0);
+    atomic_fetch_add(&dllf_generation, 1);
+    dllf_self = NULL;
+}
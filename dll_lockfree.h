@@ -0,0 +1,54 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ * 	@file   dll_lockfree.h
+ * 	@author Marc Zimmermann (tooreht@gmail.com)
+ * 	@date   December, 2012
+ * 	@brief  Lock-free work queue, header file.
+ *
+ * 	Structure and function definitions of the lock-free queue, which
+ * 	provides dll_pushTail and dll_popHead for many threads without locks.
+ * 	Every thread using a queue gets a hazard record, records are reused
+ * 	after dllf_threadExit but never freed, and popped nodes wait in them
+ * 	until no thread holds them. Both live until the process exits, or
+ * 	until dllf_cleanup once no thread uses any queue anymore, after which
+ * 	every thread may go on with new queues.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdatomic.h>
+
+typedef struct LockFreeNode
+{
+	void *data;
+	_Atomic(struct LockFreeNode*) next;
+} dllf_node_t;
+
+typedef struct lockFreeQueue
+{
+	_Alignas(64) _Atomic(dllf_node_t*) head;
+	_Alignas(64) _Atomic(dllf_node_t*) tail;
+	void (*freeFn)(void*);
+} dllf_t;
+
+dllf_t* dllf_create(void);
+void dllf_registerFreeFn(dllf_t *queue, void (*freeFn)(void*) );
+short int dllf_pushTail(dllf_t *queue, void *data);
+void* dllf_popHead(dllf_t *queue);
+void dllf_threadExit(void);
+void dllf_clear(dllf_t *queue);
+void dllf_cleanup(void);
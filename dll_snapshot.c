@@ -0,0 +1,425 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ *  @file   dll_snapshot.c
+ *  @author Marc Zimmermann (tooreht@gmail.com)
+ *  @date   December, 2012
+ *  @brief  Implementation of memory mapped snapshots of doubly linked lists.
+ *
+ *  Function implementations of the read-only snapshots.
+ *
+ *  A snapshot file starts with a dlls_header_t, followed by the nodes in
+ *  list order. Every node takes nodeSize bytes: the relative offsets of
+ *  its neighbours and a copy of the record, padded to 8 bytes. As the
+ *  offsets are relative, the file can be mapped at any address. Because
+ *  dlls_write stores the nodes in list order, the node at an index is
+ *  found in O(1) and a snapshot of a list in sorted mode is searched
+ *  binary. dlls_open checks the header and the offsets of every node
+ *  against this layout once, so the traversals never leave the mapping.
+ *  The file must not be changed while it is mapped.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+/* uncomment to ignore the assertions (no debug) */
+// #define NDEBUG
+#include <assert.h>
+
+#include "dll.h"
+#include "dll_snapshot.h"
+
+#define DLLS_MAGIC "DLLS"
+#define DLLS_IO_BUFFER (1 << 20)
+
+/**
+ * static function definitions
+ */
+static dlls_node_t* dlls_at(dlls_t *snap, unsigned long index);
+static short int dlls_valid(dlls_header_t *header, unsigned long length);
+
+/**
+ * Writes a snapshot of a list of fixed size records to a file.
+ * The data of every node is copied with recordSize bytes.
+ *
+ * @param dll_t *list: pointer to the doubly linked list
+ * @param const char *path: file name
+ * @param unsigned long recordSize: size of the data of a node
+ * @return int: success
+ */
+short int dlls_write(dll_t *list, const char *path, unsigned long recordSize)
+{
+    assert(list);
+    assert(path);
+
+    FILE *fp = fopen(path, "wb");
+    unsigned long nodeSize = (sizeof(dlls_node_t) + recordSize + 7) & ~7UL;
+    dlls_node_t *node = calloc(1, nodeSize);
+    dlls_header_t header;
+    short int ok;
+    dll_node_t *n;
+
+    if (!fp)
+    {
+        printf("ERROR: Cannot open file '%s'\n", path);
+        free(node);
+        return 0;
+    }
+
+    if (!node)
+    {
+        puts("ERROR: Out of memory");
+        fclose(fp);
+        return 0;
+    }
+
+    setvbuf(fp, NULL, _IOFBF, DLLS_IO_BUFFER);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DLLS_MAGIC, 4);
+    header.sorted = list->sorted;
+    header.recordSize = recordSize;
+    header.nodeSize = nodeSize;
+    header.size = list->size;
+    if (list->size)
+    {
+        header.head = sizeof(header);
+        header.tail = sizeof(header) + (list->size - 1) * nodeSize;
+    }
+
+    ok = fwrite(&header, sizeof(header), 1, fp);
+
+    for (n = list->head; n && ok; n = n->next)
+    {
+        node->prev = n->prev ? -(int64_t)nodeSize : 0;
+        node->next = n->next ? (int64_t)nodeSize : 0;
+        memcpy(node->data, n->data, recordSize);
+
+        ok = fwrite(node, nodeSize, 1, fp);
+    }
+
+    free(node);
+
+    if (fclose(fp) || !ok)
+    {
+        printf("ERROR: Cannot write file '%s'\n", path);
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Maps a snapshot file read-only into memory. The whole file is read
+ * once to check the offsets of the nodes.
+ *
+ * @param const char *path: file name
+ * @return dlls_t*: pointer of the snapshot, NULL on failure
+ */
+dlls_t* dlls_open(const char *path)
+{
+    assert(path);
+
+    dlls_t *snap = NULL;
+    dlls_header_t *header;
+    struct stat st;
+    void *map;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &st) || st.st_size < (off_t)sizeof(dlls_header_t))
+    {
+        printf("ERROR: Cannot open file '%s'\n", path);
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        printf("ERROR: Cannot map file '%s'\n", path);
+        return NULL;
+    }
+
+    header = map;
+
+    if (!dlls_valid(header, st.st_size))
+    {
+        printf("ERROR: Invalid snapshot '%s'\n", path);
+    }
+    else if (!(snap = malloc(sizeof(dlls_t))))
+    {
+        puts("ERROR: Out of memory");
+    }
+
+    if (!snap)
+    {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    snap->header = header;
+    snap->length = st.st_size;
+    snap->compareFn = NULL;
+
+    return snap;
+}
+
+/**
+ * Checks that a mapped file has the layout dlls_write produces: a header
+ * whose sizes fit the file, nodes of a multiple of 8 bytes, head and
+ * tail at the first and last node, and every node linked to the nodes
+ * right before and after it.
+ *
+ * @param dlls_header_t *header: start of the mapping
+ * @param unsigned long length: length of the mapping
+ * @return int: valid
+ */
+short int dlls_valid(dlls_header_t *header, unsigned long length)
+{
+    int64_t nodeSize = header->nodeSize;
+    dlls_node_t *n;
+    uint64_t i;
+
+    /* the order of the checks keeps the arithmetic from overflowing */
+    if (memcmp(header->magic, DLLS_MAGIC, 4)
+        || header->nodeSize < sizeof(dlls_node_t)
+        || header->nodeSize % 8
+        || header->nodeSize > INT64_MAX
+        || header->recordSize > header->nodeSize - sizeof(dlls_node_t)
+        || (length - sizeof(dlls_header_t)) / header->nodeSize < header->size
+        || header->head != (header->size ? sizeof(dlls_header_t) : 0)
+        || header->tail != (header->size ? sizeof(dlls_header_t) + (header->size - 1) * header->nodeSize : 0))
+        return 0;
+
+    for (i = 0; i < header->size; i++)
+    {
+        n = (dlls_node_t*)((char*)header + header->head + i * header->nodeSize);
+
+        if (n->prev != (i ? -nodeSize : 0) || n->next != (i + 1 < header->size ? nodeSize : 0))
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Unmaps the snapshot and frees it from memory.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @return void
+ */
+void dlls_close(dlls_t *snap)
+{
+    if (snap)
+    {
+        munmap(snap->header, snap->length);
+        free(snap);
+    }
+}
+
+/**
+ * Registers compareFn callback function on the snapshot.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @param int (*compareFn)(void*, void*): callback function compareFn
+ * @return void
+ */
+void dlls_registerCompareFn(dlls_t *snap, int (*compareFn)(void*, void*) )
+{
+    assert(snap);
+    assert(compareFn);
+
+    snap->compareFn = compareFn;
+}
+
+/**
+ * Returns the number of elements of the snapshot.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @return unsigned long: size
+ */
+unsigned long dlls_size(dlls_t *snap)
+{
+    assert(snap);
+
+    return snap->header->size;
+}
+
+/**
+ * Returns the first node of the snapshot.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @return dlls_node_t*: head, NULL if empty
+ */
+dlls_node_t* dlls_head(dlls_t *snap)
+{
+    assert(snap);
+
+    return snap->header->head ? (dlls_node_t*)((char*)snap->header + snap->header->head) : NULL;
+}
+
+/**
+ * Returns the last node of the snapshot.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @return dlls_node_t*: tail, NULL if empty
+ */
+dlls_node_t* dlls_tail(dlls_t *snap)
+{
+    assert(snap);
+
+    return snap->header->tail ? (dlls_node_t*)((char*)snap->header + snap->header->tail) : NULL;
+}
+
+/**
+ * Returns the next node.
+ *
+ * @param dlls_node_t *node: node of a snapshot
+ * @return dlls_node_t*: next node, NULL at the tail
+ */
+dlls_node_t* dlls_next(dlls_node_t *node)
+{
+    assert(node);
+
+    return node->next ? (dlls_node_t*)((char*)node + node->next) : NULL;
+}
+
+/**
+ * Returns the previous node.
+ *
+ * @param dlls_node_t *node: node of a snapshot
+ * @return dlls_node_t*: previous node, NULL at the head
+ */
+dlls_node_t* dlls_prev(dlls_node_t *node)
+{
+    assert(node);
+
+    return node->prev ? (dlls_node_t*)((char*)node + node->prev) : NULL;
+}
+
+/**
+ * Returns the data of a node, which points into the read-only mapping.
+ *
+ * @param dlls_node_t *node: node of a snapshot
+ * @return void*: data
+ */
+void* dlls_data(dlls_node_t *node)
+{
+    assert(node);
+
+    return node->data;
+}
+
+/**
+ * Returns the node at the index in O(1).
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @param unsigned long index: index
+ * @return dlls_node_t*: node at the index
+ */
+dlls_node_t* dlls_get(dlls_t *snap, unsigned long index)
+{
+    assert(snap);
+    assert(index < snap->header->size);
+
+    return dlls_at(snap, index);
+}
+
+/**
+ * Traverses the snapshot from head to tail.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @param void (*callback)(void*): function called with the data of every node
+ * @return void
+ */
+void dlls_traverse(dlls_t *snap, void (*callback)(void*) )
+{
+    assert(snap);
+    assert(callback);
+
+    dlls_node_t *n;
+
+    for (n = dlls_head(snap); n; n = dlls_next(n))
+    {
+        callback(n->data);
+    }
+}
+
+/**
+ * Searches for the first node with equal data. Snapshots of lists in
+ * sorted mode are searched binary in O(log n), others from head to tail.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @param void *data: data pointer
+ * @return dlls_node_t*: pointer to the found node
+ */
+dlls_node_t* dlls_search(dlls_t *snap, void *data)
+{
+    assert(snap);
+    assert(snap->compareFn);
+    assert(data);
+
+    dlls_node_t *n;
+
+    if (snap->header->sorted)
+    {
+        unsigned long lo = 0, hi = snap->header->size;
+
+        while (lo < hi)
+        {
+            unsigned long mid = lo + (hi - lo) / 2;
+
+            if (snap->compareFn(dlls_at(snap, mid)->data, data) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if (lo < snap->header->size && !snap->compareFn(dlls_at(snap, lo)->data, data))
+            return dlls_at(snap, lo);
+
+        return NULL;
+    }
+
+    for (n = dlls_head(snap); n; n = dlls_next(n))
+    {
+        if (!snap->compareFn(n->data, data))
+            return n;
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns the node at the index, the nodes are stored in list order.
+ *
+ * @param dlls_t *snap: pointer to the snapshot
+ * @param unsigned long index: index
+ * @return dlls_node_t*: node at the index
+ */
+dlls_node_t* dlls_at(dlls_t *snap, unsigned long index)
+{
+    return (dlls_node_t*)((char*)snap->header + sizeof(dlls_header_t) + index * snap->header->nodeSize);
+}
@@ -0,0 +1,74 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ * 	@file   dll_snapshot.h
+ * 	@author Marc Zimmermann (tooreht@gmail.com)
+ * 	@date   December, 2012
+ * 	@brief  Memory mapped snapshots of doubly linked lists, header file.
+ *
+ * 	Structure and function definitions of the read-only snapshots.
+ * 	A snapshot stores a list of fixed size records in a file whose nodes
+ * 	link each other with relative offsets, so the file is used directly
+ * 	through mmap without parsing and shared by processes via the page cache.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+struct doublyLinkedList;
+
+/**
+ * prev and next are byte offsets from the node itself, 0 if there is none.
+ */
+typedef struct SnapshotNode
+{
+	int64_t prev;
+	int64_t next;
+	unsigned char data[];
+} dlls_node_t;
+
+typedef struct
+{
+	char magic[4];
+	uint32_t sorted;
+	uint64_t recordSize;
+	uint64_t nodeSize;
+	uint64_t size;
+	uint64_t head;
+	uint64_t tail;
+} dlls_header_t;
+
+typedef struct doublyLinkedListSnapshot
+{
+	dlls_header_t *header;
+	unsigned long length;
+	int (*compareFn)(void*, void*);
+} dlls_t;
+
+short int dlls_write(struct doublyLinkedList *list, const char *path, unsigned long recordSize);
+dlls_t* dlls_open(const char *path);
+void dlls_close(dlls_t *snap);
+void dlls_registerCompareFn(dlls_t *snap, int (*compareFn)(void*, void*) );
+unsigned long dlls_size(dlls_t *snap);
+dlls_node_t* dlls_head(dlls_t *snap);
+dlls_node_t* dlls_tail(dlls_t *snap);
+dlls_node_t* dlls_next(dlls_node_t *node);
+dlls_node_t* dlls_prev(dlls_node_t *node);
+void* dlls_data(dlls_node_t *node);
+dlls_node_t* dlls_get(dlls_t *snap, unsigned long index);
+void dlls_traverse(dlls_t *snap, void (*callback)(void*) );
+dlls_node_t* dlls_search(dlls_t *snap, void *data);
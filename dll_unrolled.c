@@ -0,0 +1,860 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ *  @file   dll_unrolled.c
+ *  @author Marc Zimmermann (tooreht@gmail.com)
+ *  @date   December, 2012
+ *  @brief  Implementation of an unrolled doubly linked list.
+ *
+ *  Function implementations of the unrolled doublyLinkedList.
+ *  The data pointers of a node are kept packed in data[0..count-1].
+ *  A full node is split in halves on insert, an empty node is unlinked
+ *  and sparse neighbours are merged on delete.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/* uncomment to ignore the assertions (no debug) */
+// #define NDEBUG
+#include <assert.h>
+
+#include "dll_unrolled.h"
+
+/**
+ * static function definitions
+ */
+static dllu_node_t* dllu_addNode(dllu_t *list, dllu_node_t *node);
+static void dllu_removeNode(dllu_t *list, dllu_node_t *del);
+static dllu_pos_t dllu_insertAt(dllu_t *list, dllu_pos_t pos, void *data);
+static dllu_pos_t dllu_removeAt(dllu_t *list, dllu_pos_t pos);
+static dllu_pos_t dllu_locate(dllu_t *list, unsigned long index);
+static void dllu_mergeSort(dllu_t *list, void **data, void **tmp, unsigned long n);
+
+/**
+ * Creates a new unrolled doubly linked list.
+ *
+ * @param void
+ * @return dllu_t*: pointer of new unrolled doubly linked list
+ */
+dllu_t* dllu_create(void)
+{
+    dllu_t *new = malloc(sizeof(dllu_t));
+
+    if (new)
+    {
+        new->head = new->tail = NULL;
+        new->size = 0;
+        new->compareFn = NULL;
+        new->freeFn = NULL;
+        new->printFn = NULL;
+    }
+    else
+    {
+        puts("ERROR: Out of memory");
+    }
+
+    return new;
+}
+
+/**
+ * Registers compareFn callback function on the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param int (*compareFn)(void*, void*): callback function compareFn
+ * @return void
+ */
+void dllu_registerCompareFn(dllu_t *list, int (*compareFn)(void*, void*) )
+{
+    assert(list);
+    assert(compareFn);
+
+    list->compareFn = compareFn;
+}
+
+/**
+ * Registers freeFn callback function on the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void (*freeFn)(void*): callback function freeFn
+ * @return void
+ */
+void dllu_registerFreeFn(dllu_t *list, void (*freeFn)(void*) )
+{
+    assert(list);
+    assert(freeFn);
+
+    list->freeFn = freeFn;
+}
+
+/**
+ * Registers printFn callback function on the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void (*printFn)(void*): callback function printFn
+ * @return void
+ */
+void dllu_registerPrintFn(dllu_t *list, void (*printFn)(void*) )
+{
+    assert(list);
+    assert(printFn);
+
+    list->printFn = printFn;
+}
+
+/**
+ * Returns the number of data pointers in the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return unsigned long: size
+ */
+unsigned long dllu_size(dllu_t *list)
+{
+    assert(list);
+
+    return list->size;
+}
+
+/**
+ * Traverses the list, while providing each data pointer to a callback function.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void (*callback)(void*): callback function
+ * @return void
+ */
+void dllu_traverse(dllu_t *list, void (*callback)(void*) )
+{
+    assert(list);
+    assert(callback);
+
+    dllu_node_t *n;
+    unsigned int i;
+
+    for (n = list->head; n; n = n->next)
+    {
+        for (i = 0; i < n->count; i++)
+            callback(n->data[i]);
+    }
+}
+
+/**
+ * Finds the position of the index. Whole nodes are skipped by their count,
+ * starting from the closer end.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param unsigned long index: index
+ * @return dllu_pos_t: position of the index
+ */
+dllu_pos_t dllu_locate(dllu_t *list, unsigned long index)
+{
+    assert(list);
+    assert(index < list->size);
+
+    dllu_pos_t pos;
+
+    if (index < list->size / 2)
+    {
+        pos.node = list->head;
+
+        while (index >= pos.node->count)
+        {
+            index -= pos.node->count;
+            pos.node = pos.node->next;
+        }
+        pos.slot = index;
+    }
+    else
+    {
+        index = list->size - index - 1;
+        pos.node = list->tail;
+
+        while (index >= pos.node->count)
+        {
+            index -= pos.node->count;
+            pos.node = pos.node->prev;
+        }
+        pos.slot = pos.node->count - index - 1;
+    }
+
+    return pos;
+}
+
+/**
+ * Gets the data pointer at the index.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param unsigned long index: index
+ * @return void*: data pointer
+ */
+void* dllu_get(dllu_t *list, unsigned long index)
+{
+    dllu_pos_t pos = dllu_locate(list, index);
+
+    return pos.node->data[pos.slot];
+}
+
+/**
+ * Returns the position of the first data pointer.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return dllu_pos_t: position of the head, its node is NULL if the list is empty
+ */
+dllu_pos_t dllu_head(dllu_t *list)
+{
+    assert(list);
+
+    dllu_pos_t pos = { list->head, 0 };
+
+    return pos;
+}
+
+/**
+ * Returns the position of the last data pointer.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return dllu_pos_t: position of the tail, its node is NULL if the list is empty
+ */
+dllu_pos_t dllu_tail(dllu_t *list)
+{
+    assert(list);
+
+    dllu_pos_t pos = { list->tail, 0 };
+
+    if (pos.node)
+        pos.slot = pos.node->count - 1;
+
+    return pos;
+}
+
+/**
+ * Returns the position after a position.
+ *
+ * @param dllu_pos_t pos: position
+ * @return dllu_pos_t: next position, its node is NULL after the tail
+ */
+dllu_pos_t dllu_next(dllu_pos_t pos)
+{
+    assert(pos.node);
+
+    if (++pos.slot == pos.node->count)
+    {
+        pos.node = pos.node->next;
+        pos.slot = 0;
+    }
+
+    return pos;
+}
+
+/**
+ * Returns the position before a position.
+ *
+ * @param dllu_pos_t pos: position
+ * @return dllu_pos_t: previous position, its node is NULL before the head
+ */
+dllu_pos_t dllu_prev(dllu_pos_t pos)
+{
+    assert(pos.node);
+
+    if (pos.slot)
+    {
+        pos.slot--;
+    }
+    else
+    {
+        pos.node = pos.node->prev;
+
+        if (pos.node)
+            pos.slot = pos.node->count - 1;
+    }
+
+    return pos;
+}
+
+/**
+ * Returns the data pointer at a position.
+ *
+ * @param dllu_pos_t pos: position
+ * @return void*: data pointer
+ */
+void* dllu_data(dllu_pos_t pos)
+{
+    assert(pos.node);
+
+    return pos.node->data[pos.slot];
+}
+
+/**
+ * Searches for a data pointer with the specific data.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void *data: data pointer
+ * @param int mode: search mode (1=head to tail, 2=tail to head, 3=head and tail)
+ * @return dllu_pos_t: position of the found data, the node is NULL if not found
+ */
+dllu_pos_t dllu_search(dllu_t *list, void *data, short int mode)
+{
+    assert(list);
+    assert(list->compareFn);
+    assert(data);
+    assert(mode >= 1 && mode <= 3);
+
+    dllu_pos_t pos, back;
+    unsigned long left;
+    unsigned int i;
+
+    if (mode == 3)
+    {
+        pos = dllu_head(list);
+        back = dllu_tail(list);
+
+        /* one step from each end until they meet */
+        for (left = list->size; left; left--)
+        {
+            if (!list->compareFn(pos.node->data[pos.slot], data))
+                return pos;
+
+            if (!--left)
+                break;
+
+            if (!list->compareFn(back.node->data[back.slot], data))
+                return back;
+
+            pos = dllu_next(pos);
+            back = dllu_prev(back);
+        }
+
+        pos.node = NULL;
+    }
+    else if (mode == 2)
+    {
+        for (pos.node = list->tail; pos.node; pos.node = pos.node->prev)
+        {
+            for (i = pos.node->count; i--; )
+            {
+                if (!list->compareFn(pos.node->data[i], data))
+                {
+                    pos.slot = i;
+                    return pos;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (pos.node = list->head; pos.node; pos.node = pos.node->next)
+        {
+            for (i = 0; i < pos.node->count; i++)
+            {
+                if (!list->compareFn(pos.node->data[i], data))
+                {
+                    pos.slot = i;
+                    return pos;
+                }
+            }
+        }
+    }
+
+    pos.slot = 0;
+
+    return pos;
+}
+
+/**
+ * Sets the data pointer at the index to a specific value.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param unsigned long index: index
+ * @param void *data: data pointer
+ * @return void
+ */
+void dllu_set(dllu_t *list, unsigned long index, void *data)
+{
+    assert(data);
+
+    dllu_pos_t pos = dllu_locate(list, index);
+
+    pos.node->data[pos.slot] = data;
+}
+
+/**
+ * Creates an empty node and links it after a specific node.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param dllu_node_t *node: node to add after, NULL to add as head
+ * @return dllu_node_t*: pointer to the new node
+ */
+dllu_node_t* dllu_addNode(dllu_t *list, dllu_node_t *node)
+{
+    dllu_node_t *new = malloc(sizeof(dllu_node_t));
+
+    if (new)
+    {
+        new->count = 0;
+        new->prev = node;
+        new->next = node ? node->next : list->head;
+
+        if (new->next)
+            new->next->prev = new;
+        else
+            list->tail = new;
+
+        if (node)
+            node->next = new;
+        else
+            list->head = new;
+    }
+    else
+    {
+        puts("ERROR: Out of memory");
+    }
+
+    return new;
+}
+
+/**
+ * Unlinks a node and frees it from memory, its data pointers are not freed.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param dllu_node_t *del: node to remove
+ * @return void
+ */
+void dllu_removeNode(dllu_t *list, dllu_node_t *del)
+{
+    if (del->prev)
+        del->prev->next = del->next;
+    else
+        list->head = del->next;
+
+    if (del->next)
+        del->next->prev = del->prev;
+    else
+        list->tail = del->prev;
+
+    free(del);
+}
+
+/**
+ * Inserts a data pointer at a position, the following data pointers
+ * of the node are shifted. A full node is split in halves first.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param dllu_pos_t pos: position, the slot may be equal to the count
+ * @param void *data: data pointer
+ * @return dllu_pos_t: position of the inserted data
+ */
+dllu_pos_t dllu_insertAt(dllu_t *list, dllu_pos_t pos, void *data)
+{
+    assert(pos.node);
+    assert(pos.slot <= pos.node->count);
+
+    if (pos.node->count == DLLU_SLOTS)
+    {
+        unsigned int half = DLLU_SLOTS / 2;
+        dllu_node_t *new = dllu_addNode(list, pos.node);
+
+        if (!new)
+        {
+            pos.node = NULL;
+            return pos;
+        }
+
+        memcpy(new->data, pos.node->data + half, (DLLU_SLOTS - half) * sizeof(void*));
+        new->count = DLLU_SLOTS - half;
+        pos.node->count = half;
+
+        if (pos.slot > half)
+        {
+            pos.node = new;
+            pos.slot -= half;
+        }
+    }
+
+    memmove(pos.node->data + pos.slot + 1, pos.node->data + pos.slot,
+            (pos.node->count - pos.slot) * sizeof(void*));
+    pos.node->data[pos.slot] = data;
+    pos.node->count++;
+    list->size++;
+
+    return pos;
+}
+
+/**
+ * Removes the data pointer at a position without freeing it.
+ * Empty nodes are unlinked, sparse neighbours are merged.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param dllu_pos_t pos: position
+ * @return dllu_pos_t: position of the following data, its node is NULL at the end
+ */
+dllu_pos_t dllu_removeAt(dllu_t *list, dllu_pos_t pos)
+{
+    assert(pos.node);
+    assert(pos.slot < pos.node->count);
+
+    dllu_node_t *n = pos.node, *next = n->next;
+
+    n->count--;
+    memmove(n->data + pos.slot, n->data + pos.slot + 1, (n->count - pos.slot) * sizeof(void*));
+    list->size--;
+
+    if (!n->count)
+    {
+        dllu_removeNode(list, n);
+        pos.node = next;
+        pos.slot = 0;
+
+        return pos;
+    }
+
+    if (next && n->count + next->count <= DLLU_SLOTS / 2)
+    {
+        memcpy(n->data + n->count, next->data, next->count * sizeof(void*));
+        n->count += next->count;
+        dllu_removeNode(list, next);
+    }
+
+    if (pos.slot == n->count)
+    {
+        pos.node = n->next;
+        pos.slot = 0;
+    }
+
+    return pos;
+}
+
+/**
+ * Pushs a data pointer to the head of the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void *data: data pointer
+ * @return dllu_pos_t: position of the pushed data, its node is NULL if out of memory
+ */
+dllu_pos_t dllu_pushHead(dllu_t *list, void *data)
+{
+    assert(list);
+    assert(data);
+
+    dllu_pos_t pos;
+
+    pos.node = NULL;
+    pos.slot = 0;
+
+    if ((!list->head || list->head->count == DLLU_SLOTS) && !dllu_addNode(list, NULL))
+        return pos;
+
+    pos.node = list->head;
+
+    return dllu_insertAt(list, pos, data);
+}
+
+/**
+ * Pushs a data pointer to the tail of the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void *data: data pointer
+ * @return dllu_pos_t: position of the pushed data, its node is NULL if out of memory
+ */
+dllu_pos_t dllu_pushTail(dllu_t *list, void *data)
+{
+    assert(list);
+    assert(data);
+
+    dllu_pos_t pos;
+
+    pos.node = NULL;
+    pos.slot = 0;
+
+    if ((!list->tail || list->tail->count == DLLU_SLOTS) && !dllu_addNode(list, list->tail))
+        return pos;
+
+    pos.node = list->tail;
+    pos.slot = pos.node->count;
+
+    return dllu_insertAt(list, pos, data);
+}
+
+/**
+ * Adds a data pointer before a specific position.
+ * Only the data pointers of one node are moved.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param dllu_pos_t pos: position to add before
+ * @param void *data: data pointer
+ * @return dllu_pos_t: position of the added data
+ */
+dllu_pos_t dllu_addBefore(dllu_t *list, dllu_pos_t pos, void *data)
+{
+    assert(list);
+    assert(data);
+
+    return dllu_insertAt(list, pos, data);
+}
+
+/**
+ * Adds a data pointer after a specific position.
+ * Only the data pointers of one node are moved.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param dllu_pos_t pos: position to add after
+ * @param void *data: data pointer
+ * @return dllu_pos_t: position of the added data
+ */
+dllu_pos_t dllu_addAfter(dllu_t *list, dllu_pos_t pos, void *data)
+{
+    assert(list);
+    assert(data);
+
+    pos.slot++;
+
+    return dllu_insertAt(list, pos, data);
+}
+
+/**
+ * Frees the data at a position and removes it from the list. The data
+ * is only freed if freeFn is registered. Other positions into the same
+ * or the next node are invalid afterwards, use the returned one to go on.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param dllu_pos_t pos: position
+ * @return dllu_pos_t: position of the following data, its node is NULL at the end
+ */
+dllu_pos_t dllu_erase(dllu_t *list, dllu_pos_t pos)
+{
+    assert(list);
+
+    if (pos.node)
+    {
+        if (list->freeFn)
+            list->freeFn(pos.node->data[pos.slot]);
+
+        pos = dllu_removeAt(list, pos);
+    }
+
+    return pos;
+}
+
+/**
+ * Deletes the data at the specific index.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param unsigned long index: index
+ * @return void
+ */
+void dllu_delete(dllu_t *list, unsigned long index)
+{
+    dllu_erase(list, dllu_locate(list, index));
+}
+
+/**
+ * Deletes the first data pointer with the specific data from the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void *data: data pointer
+ * @param int mode: search mode
+ * @return void
+ */
+void dllu_searchAndDelete(dllu_t *list, void *data, short int mode)
+{
+    dllu_erase(list, dllu_search(list, data, mode));
+}
+
+/**
+ * Deletes the first data pointer of the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return void
+ */
+void dllu_popHead(dllu_t *list)
+{
+    assert(list);
+
+    dllu_pos_t pos = { list->head, 0 };
+
+    dllu_erase(list, pos);
+}
+
+/**
+ * Deletes the last data pointer of the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return void
+ */
+void dllu_popTail(dllu_t *list)
+{
+    assert(list);
+
+    dllu_pos_t pos = { list->tail, 0 };
+
+    if (pos.node)
+        pos.slot = pos.node->count - 1;
+
+    dllu_erase(list, pos);
+}
+
+/**
+ * Reverses the list: the nodes are relinked in reverse order and the
+ * data pointers of each node are reversed in place.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return void
+ */
+void dllu_reverse(dllu_t *list)
+{
+    assert(list);
+
+    dllu_node_t *n, *swap;
+    unsigned int i;
+    void *data;
+
+    for (n = list->head; n; n = n->prev)
+    {
+        swap = n->next;
+        n->next = n->prev;
+        n->prev = swap;
+
+        for (i = 0; i < n->count / 2; i++)
+        {
+            data = n->data[i];
+            n->data[i] = n->data[n->count - i - 1];
+            n->data[n->count - i - 1] = data;
+        }
+    }
+
+    swap = list->head;
+    list->head = list->tail;
+    list->tail = swap;
+}
+
+/**
+ * Sorts the list through the compareFn function with a stable merge
+ * sort. The data pointers are gathered into an array, sorted, and
+ * written back into the same nodes, which keep their counts.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return int: success
+ */
+short int dllu_sort(dllu_t *list)
+{
+    assert(list);
+    assert(list->compareFn);
+
+    dllu_node_t *n;
+    void **data;
+    unsigned long k = 0;
+
+    if (list->size < 2)
+        return 1;
+
+    data = malloc(2 * list->size * sizeof(void*));
+
+    if (!data)
+    {
+        puts("ERROR: Out of memory");
+        return 0;
+    }
+
+    for (n = list->head; n; k += n->count, n = n->next)
+        memcpy(data + k, n->data, n->count * sizeof(void*));
+
+    dllu_mergeSort(list, data, data + list->size, list->size);
+
+    for (n = list->head, k = 0; n; k += n->count, n = n->next)
+        memcpy(n->data, data + k, n->count * sizeof(void*));
+
+    free(data);
+
+    return 1;
+}
+
+/**
+ * Sorts an array of data pointers with a stable top-down merge sort.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @param void **data: data pointers to sort
+ * @param void **tmp: scratch space of n data pointers
+ * @param unsigned long n: number of data pointers
+ * @return void
+ */
+void dllu_mergeSort(dllu_t *list, void **data, void **tmp, unsigned long n)
+{
+    unsigned long half = n / 2, i = 0, j = half, k = 0;
+
+    if (n < 2)
+        return;
+
+    dllu_mergeSort(list, data, tmp, half);
+    dllu_mergeSort(list, data + half, tmp, n - half);
+
+    /* already in order, e.g. sorted input */
+    if (list->compareFn(data[half - 1], data[half]) <= 0)
+        return;
+
+    while (i < half && j < n)
+        tmp[k++] = list->compareFn(data[j], data[i]) < 0 ? data[j++] : data[i++];
+
+    while (i < half)
+        tmp[k++] = data[i++];
+
+    memcpy(data, tmp, k * sizeof(void*));
+}
+
+/**
+ * Destroys the whole list and frees it from memory.
+ * The data is only freed if freeFn is registered.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return void
+ */
+void dllu_clear(dllu_t *list)
+{
+    if (list)
+    {
+        dllu_node_t *n = list->head;
+        unsigned int i;
+
+        while (n)
+        {
+            dllu_node_t *del = n;
+
+            for (i = 0; list->freeFn && i < n->count; i++)
+                list->freeFn(n->data[i]);
+
+            n = n->next;
+            free(del);
+        }
+        free(list);
+    }
+}
+
+/**
+ * Prints the list.
+ *
+ * @param dllu_t *list: pointer to the unrolled doubly linked list
+ * @return void
+ */
+void dllu_print(dllu_t *list)
+{
+    assert(list);
+    assert(list->printFn);
+
+    printf("--- head ---\n");
+
+    dllu_traverse(list, list->printFn);
+
+    printf("--- tail ---\n");
+}
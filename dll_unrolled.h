@@ -0,0 +1,83 @@
+/**
+ *  doublyLinkedList
+ *
+ *  https://github.com/tooreht/doublyLinkedList
+ *
+ * 	@file   dll_unrolled.h
+ * 	@author Marc Zimmermann (tooreht@gmail.com)
+ * 	@date   December, 2012
+ * 	@brief  Unrolled doubly linked list, header file.
+ *
+ * 	Structure and function definitions of the unrolled doublyLinkedList.
+ * 	Each node stores up to DLLU_SLOTS data pointers, so linear scans touch
+ * 	much fewer cache lines than the one-pointer-per-node dll_t.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DLLU_SLOTS
+#define DLLU_SLOTS 16
+#endif
+
+typedef struct UnrolledNode
+{
+	struct UnrolledNode *prev;
+	struct UnrolledNode *next;
+	unsigned int count;
+	void *data[DLLU_SLOTS];
+} dllu_node_t;
+
+typedef struct
+{
+	dllu_node_t *node;
+	unsigned int slot;
+} dllu_pos_t;
+
+typedef struct unrolledDoublyLinkedList
+{
+	dllu_node_t *head;
+	dllu_node_t *tail;
+	unsigned long size;
+	int (*compareFn)(void*, void*);
+	void (*freeFn)(void*);
+	void (*printFn)(void*);
+} dllu_t;
+
+dllu_t* dllu_create(void);
+void dllu_registerCompareFn(dllu_t *list, int (*compareFn)(void*, void*) );
+void dllu_registerFreeFn(dllu_t *list, void (*freeFn)(void*) );
+void dllu_registerPrintFn(dllu_t *list, void (*printFn)(void*) );
+unsigned long dllu_size(dllu_t *list);
+void dllu_traverse(dllu_t *list, void (*callback)(void*) );
+void* dllu_get(dllu_t *list, unsigned long index);
+dllu_pos_t dllu_head(dllu_t *list);
+dllu_pos_t dllu_tail(dllu_t *list);
+dllu_pos_t dllu_next(dllu_pos_t pos);
+dllu_pos_t dllu_prev(dllu_pos_t pos);
+void* dllu_data(dllu_pos_t pos);
+dllu_pos_t dllu_search(dllu_t *list, void *data, short int mode);
+void dllu_set(dllu_t *list, unsigned long index, void *data);
+dllu_pos_t dllu_pushHead(dllu_t *list, void *data);
+dllu_pos_t dllu_pushTail(dllu_t *list, void *data);
+dllu_pos_t dllu_addBefore(dllu_t *list, dllu_pos_t pos, void *data);
+dllu_pos_t dllu_addAfter(dllu_t *list, dllu_pos_t pos, void *data);
+dllu_pos_t dllu_erase(dllu_t *list, dllu_pos_t pos);
+void dllu_delete(dllu_t *list, unsigned long index);
+void dllu_searchAndDelete(dllu_t *list, void *data, short int mode);
+void dllu_popHead(dllu_t *list);
+void dllu_popTail(dllu_t *list);
+void dllu_reverse(dllu_t *list);
+short int dllu_sort(dllu_t *list);
+void dllu_clear(dllu_t *list);
+void dllu_print(dllu_t *list);
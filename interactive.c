@@ -31,6 +31,7 @@
 #include <time.h>
 
 #include "dll.h"
+#include "dll_snapshot.h"
 
 dll_t *list;
 int *d1, *d2;
@@ -60,6 +61,12 @@ void usage(void)
     puts("popHead (poh)\t\tpop the first node");
     puts("popTail(pot)\t\tpop the last node");
     puts("clear\t\tclear the whole list");
+    puts("save\t\tsave the list to the file list.dll");
+    puts("load\t\tappend the elements of the file list.dll to the list");
+    puts("snapshot\twrite a snapshot of the list to the file list.snap");
+    puts("mapped\t\tprint the list from the mapped snapshot list.snap");
+    puts("compact\t\tmove the nodes into one block in list order");
+    puts("stats\t\tprint the statistics of the list (build with -DDLL_STATS)");
     puts("");
     puts("get 1 \t\tget the node at the index");
     puts("pushHead 1 (puh)\tpush an integer to the head of the list");
@@ -67,16 +74,15 @@ void usage(void)
     puts("find 1\t\tsearch for an integer in the list");
     puts("del 1\t\tdelete an integer in the list");
     puts("sad 1\t\tsearch and delete an integer in the list");
-    puts("perform 10\tdo some performance testing with a number of elements");
     puts("");
     puts("set 1 2 \tset the node at the index 1 to 2");
     puts("before 1 2\tadd integer 2 before integer 1 in the list");
     puts("after 1 2\tadd integer 2 after integer 1 in the list");
     puts("fill 10 20\tfill the list with integers from 10 to 20");
-    puts("find 10 1|2|3\tsearch for an integer in the list with a specific search mode");
-    puts("\t\t(modes: 1=head to tail, 2=tail to head, 3=head and tail)");
-    puts("sad 10 1|2|3\tsearch and delete an integer in the list with a specific search");
-    puts("\t\tmode (modes: 1=head to tail, 2=tail to head, 3=head and tail)");
+    puts("find 10 1|2|3|4\tsearch for an integer in the list with a specific search mode");
+    puts("\t\t(modes: 1=head to tail, 2=tail to head, 3=head and tail, 4=hash)");
+    puts("sad 10 1|2|3|4\tsearch and delete an integer in the list with a specific search");
+    puts("\t\tmode (modes: 1=head to tail, 2=tail to head, 3=head and tail, 4=hash)");
 }
 
 /**
@@ -233,82 +239,50 @@ int compareFn(void *first_arg, void *second_arg)
 }
 
 /**
- * Performs some tests with a dynamic number of elements.
+ * This callback function is feed with the data pointer to hash the data.
+ * Equal integers have to return the same hash.
  *
- * @param int elements: number of elements
- * @return void
+ * @param void* data
+ * @return unsigned long
  */
-void perform(int elements)
+unsigned long hashFn(void *data)
 {
-    clock_t start = clock();
-
-    int *integer;
-    void *data;
-
-    puts("fill dll with 'conventional' for loop");
-    int i;
-    for(i = 0; i < elements; i++)
-    {
-        integer = malloc(sizeof(int));
-        *integer = i;
-        data = integer;
-        dll_pushTail(list, data);
-    }
-
-    puts("print dll with 'iterator' while loop head to tail");
-    dll_head(list);
-    while(dll_hasNext(list))
-    {
-        printf("%d\n", *(int*)list->curr->data);
-        dll_next(list);
-    }
+    return (unsigned int) *(int *) data * 2654435761UL;
+}
 
-    // puts("sort");
-    // dll_sort(list);
-    puts("reverse");
-    dll_reverse(list);
-    // dll_print(list);
+/**
+ * This callback function is feed with the data pointer to write the
+ * integer into a buffer for saving the list.
+ *
+ * @param void* data
+ * @param void* buffer
+ * @param unsigned long size: size of the buffer
+ * @return unsigned long: bytes needed
+ */
+unsigned long serializeFn(void *data, void *buffer, unsigned long size)
+{
+    if(size >= sizeof(int))
+        memcpy(buffer, data, sizeof(int));
 
-    puts("print dll with 'iterator' for loop tail to head");
-    dll_node_t *n = NULL;
-    for(n = dll_tail(list); dll_hasPrev(list); n = dll_prev(list))
-    {
-        printf("%d\n", *(int*)n->data);
-    }
+    return sizeof(int);
+}
 
-    // puts("delete dll with for loop 'conventional' (dll_searchAndDelete is slow because of searching data)");
-    // for(i = 0; i < elements; i++)
-    // {
-    //  data = &i;
-    //  dll_searchAndDelete(list, data, 0);
-    // }
-
-    // puts("delete dll with while loop 'iterator' head to tail");
-    // dll_head(list);
-    // while(dll_hasNext(list))
-    // {
-    //  dll_next(list);
-    //  dll_popHead(list);
-    // }
-
-    int contains = 1;
-    void *d = &contains;
-    dll_node_t *node = dll_search(list, d, 1);
-    printf("contains %d\n", dll_contains(list, node));
-
-    puts("delete dll with 'iterator' while loop tail to head");
-    dll_tail(list);
-    while(dll_hasPrev(list))
-    {
-        dll_prev(list);
-        dll_popTail(list);
-    }
+/**
+ * This callback function is feed with a buffer written by serializeFn
+ * to create an integer for loading the list.
+ *
+ * @param void* buffer
+ * @param unsigned long size: size of the buffer
+ * @return void*: pointer to the integer, NULL on failure
+ */
+void* deserializeFn(void *buffer, unsigned long size)
+{
+    int *data = NULL;
 
-    puts("print list");
-    dll_print(list);
+    if(size == sizeof(int) && (data = malloc(sizeof(int))))
+        memcpy(data, buffer, sizeof(int));
 
-    double elapsed = ( (double)clock() - start ) / CLOCKS_PER_SEC;
-    printf("Performance with %d elements finished in %f s\n", elements, elapsed);
+    return data;
 }
 
 /**
@@ -320,34 +294,37 @@ void perform(int elements)
  */
 void fill(int beg, int end)
 {
+    int step = beg > end ? -1 : 1;
+    unsigned long n = (beg > end ? beg - end : end - beg) + 1, j;
+    void **items = malloc(n * sizeof(void*));
     int *integer;
-    void *data;
-    int i;
+
+    if (!items)
+    {
+        puts("ERROR: Out of memory");
+        return;
+    }
 
     clock_t start = clock();
 
-    if(beg > end)
+    for (j = 0; j < n; j++)
     {
-        for(i = beg; i >= end; i--)
-        {
-            integer = malloc(sizeof(int));
-            *integer = i;
-            data = integer;
-            dll_pushTail(list, data);
-        }
-
+        integer = malloc(sizeof(int));
+        *integer = beg + step * (int) j;
+        items[j] = integer;
     }
-    else
+
+    if (!dll_pushTailBulk(list, items, n))
     {
-        for(i = beg; i <= end; i++)
-        {
-            integer = malloc(sizeof(int));
-            *integer = i;
-            data = integer;
-            dll_pushTail(list, data);
-        }
+        for (j = 0; j < n; j++)
+            free(items[j]);
+        free(items);
+        puts("ERROR: Cannot fill the list");
+        return;
     }
 
+    free(items);
+
     double elapsed = ( (double)clock() - start ) / CLOCKS_PER_SEC;
     printf("Filling finished in %f s\n", elapsed);
 }
@@ -376,10 +353,14 @@ void executeDll(int nargs, char *command, int arg1, int arg2)
 
     if(!list)
     {
-        list = dll_create();
+        // with a node pool, so the list can be compacted
+        list = dll_createWithPool(64);
         dll_registerCompareFn(list, compareFn);
         dll_registerFreeFn(list, freeFn);
         dll_registerPrintFn(list, printFn);
+        dll_registerHashFn(list, hashFn);
+        dll_registerSerializeFn(list, serializeFn);
+        dll_registerDeserializeFn(list, deserializeFn);
     }
 
     switch(nargs)
@@ -445,7 +426,8 @@ void executeDll(int nargs, char *command, int arg1, int arg2)
             }
             else if(!strcmp(command, "sort"))
             {
-                dll_sort(list);
+                if (!dll_sortByIntKey(list, 0, DLL_KEY_I32))
+                    dll_sort(list);
             }
             else if(!strcmp(command, "popHead") || !strcmp(command, "poh"))
             {
@@ -466,6 +448,66 @@ void executeDll(int nargs, char *command, int arg1, int arg2)
 
                 list = NULL;
             }
+            else if(!strcmp(command, "save"))
+            {
+                if(dll_save(list, "list.dll"))
+                    printf("Saved %ld elements to list.dll\n", dll_size(list));
+            }
+            else if(!strcmp(command, "load"))
+            {
+                clock_t start = clock();
+
+                if(dll_load(list, "list.dll"))
+                {
+                    double elapsed = ( (double)clock() - start ) / CLOCKS_PER_SEC;
+                    printf("Loading finished in %f s\n", elapsed);
+                }
+            }
+            else if(!strcmp(command, "snapshot"))
+            {
+                if(dlls_write(list, "list.snap", sizeof(int)))
+                    printf("Wrote a snapshot of %ld elements to list.snap\n", dll_size(list));
+            }
+            else if(!strcmp(command, "mapped"))
+            {
+                dlls_t *snap = dlls_open("list.snap");
+
+                if(snap)
+                {
+                    printf("--- head ---\n");
+                    dlls_traverse(snap, printFn);
+                    printf("--- tail ---\n");
+                    dlls_close(snap);
+                }
+            }
+            else if(!strcmp(command, "compact"))
+            {
+                if(dll_compact(list))
+                    puts("Compacted the list");
+                else
+                    puts("ERROR: Cannot compact the list");
+            }
+            else if(!strcmp(command, "stats"))
+            {
+                dll_stats_t stats;
+
+                if(dll_stats(list, &stats))
+                {
+                    printf("inserts: %llu, deletes: %llu, gets: %llu, searches: %llu\n",
+                        stats.ops[DLL_OP_INSERT], stats.ops[DLL_OP_DELETE], stats.ops[DLL_OP_GET], stats.ops[DLL_OP_SEARCH]);
+                    printf("sorts: %llu, reverses: %llu, splices: %llu, traversals: %llu\n",
+                        stats.ops[DLL_OP_SORT], stats.ops[DLL_OP_REVERSE], stats.ops[DLL_OP_SPLICE], stats.ops[DLL_OP_TRAVERSE]);
+                    printf("compares: %llu, get visits: %llu, search visits: %llu, allocs: %llu, frees: %llu\n",
+                        stats.compares, stats.getVisits, stats.searchVisits, stats.allocs, stats.frees);
+                    printf("get latency p50/p99: %llu/%llu ns, search latency p50/p99: %llu/%llu ns\n",
+                        dll_statsPercentile(stats.getLatency, 50), dll_statsPercentile(stats.getLatency, 99),
+                        dll_statsPercentile(stats.searchLatency, 50), dll_statsPercentile(stats.searchLatency, 99));
+                }
+                else
+                {
+                    puts("Statistics are disabled, build with -DDLL_STATS");
+                }
+            }
             else if(!strcmp(command, "show"))
             {
                 // do absolutely nothing
@@ -508,10 +550,6 @@ void executeDll(int nargs, char *command, int arg1, int arg2)
             {
                 dll_searchAndDelete(list, a1, 0);
             }
-            else if(!strcmp(command, "perform"))
-            {
-                perform(arg1);
-            }
             else
             {
                 usage();
@@ -204,6 +204,14 @@ int main(int argc, char const *argv[])
         dll_next(list);
     }
 
+    // use an iterator, which keeps its own position, to print the sorted list backwards
+    puts("backwards");
+    dll_iter_t it;
+    for(dll_iterTail(&it, list); dll_iterValid(&it); dll_iterPrev(&it))
+    {
+        printFn(dll_iterNode(&it)->data);
+    }
+
     printf("List size: %ld\n", dll_size(list));
 
     // empty the whole list